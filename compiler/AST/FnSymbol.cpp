@@ -60,6 +60,8 @@ FnSymbol::FnSymbol(const char* initName)
   _instantiationPoint = NULL;
   _backupInstantiationPoint = NULL;
   basicBlocks        = NULL;
+  bodyVersion        = 0;
+  analyses           = NULL;
   calledBy           = NULL;
   userString         = NULL;
   valueFunction      = NULL;
@@ -0,0 +1,145 @@
+/*
+ * Copyright 2020 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "analysisManager.h"
+
+#include "bb.h"
+#include "bitVec.h"
+#include "dominator.h"
+#include "driver.h"
+#include "FnSymbol.h"
+#include "optimizations.h"
+#include "stlUtil.h"
+
+// Reported under --print-statistics.  Analyses may be requested from
+// several threads, hence the atomic increments.
+static unsigned long nBasicBlockRequests  = 0;
+static unsigned long nBasicBlockBuilds    = 0;
+static unsigned long nDominatorRequests   = 0;
+static unsigned long nDominatorBuilds     = 0;
+static unsigned long nLiveRequests        = 0;
+static unsigned long nLiveBuilds          = 0;
+
+static void count(unsigned long* counter) {
+  __sync_fetch_and_add(counter, 1);
+}
+
+FnAnalyses::FnAnalyses() {
+  version = 0;
+  live    = NULL;
+}
+
+FnAnalyses::~FnAnalyses() {
+  for_vector(BitVec, dominator, dominators)
+    delete dominator;
+
+  if (live != NULL) {
+    for_vector(BitVec, out, live->OUT)
+      delete out;
+
+    delete live;
+  }
+}
+
+std::vector<BasicBlock*>& getBasicBlocks(FnSymbol* fn) {
+  count(&nBasicBlockRequests);
+
+  if (fn->basicBlocks == NULL            ||
+      fn->analyses    == NULL            ||
+      fn->analyses->version != fn->bodyVersion) {
+    count(&nBasicBlockBuilds);
+
+    // This also frees the analyses derived from the old blocks
+    BasicBlock::buildBasicBlocks(fn);
+
+    fn->analyses          = new FnAnalyses();
+    fn->analyses->version = fn->bodyVersion;
+  }
+
+  return *fn->basicBlocks;
+}
+
+std::vector<BitVec*>& getDominators(FnSymbol* fn) {
+  std::vector<BasicBlock*>& basicBlocks = getBasicBlocks(fn);
+  std::vector<BitVec*>&     dominators  = fn->analyses->dominators;
+
+  count(&nDominatorRequests);
+
+  if (dominators.size() == 0) {
+    count(&nDominatorBuilds);
+
+    for (size_t i = 0; i < basicBlocks.size(); i++)
+      dominators.push_back(new BitVec(basicBlocks.size()));
+
+    computeDominators(dominators, basicBlocks);
+  }
+
+  return dominators;
+}
+
+LiveVariables& getLiveVariables(FnSymbol* fn) {
+  getBasicBlocks(fn);
+
+  count(&nLiveRequests);
+
+  if (fn->analyses->live == NULL) {
+    LiveVariables* live = new LiveVariables();
+
+    count(&nLiveBuilds);
+
+    liveVariableAnalysis(fn,
+                         live->locals,
+                         live->localMap,
+                         live->useSet,
+                         live->defSet,
+                         live->OUT);
+
+    fn->analyses->live = live;
+  }
+
+  return *fn->analyses->live;
+}
+
+void freeAnalyses(FnSymbol* fn) {
+  BasicBlock::clear(fn);
+}
+
+void freeAllAnalyses(const char* passName) {
+  forv_Vec(FnSymbol, fn, gFnSymbols) {
+    freeAnalyses(fn);
+  }
+
+  if (fPrintStatistics[0] != '\0' && nBasicBlockRequests > 0) {
+    fprintf(stderr,
+            "%s: reused basic blocks for %lu of %lu requests, "
+            "dominators for %lu of %lu, live variables for %lu of %lu\n",
+            passName,
+            nBasicBlockRequests - nBasicBlockBuilds, nBasicBlockRequests,
+            nDominatorRequests  - nDominatorBuilds,  nDominatorRequests,
+            nLiveRequests       - nLiveBuilds,       nLiveRequests);
+  }
+
+  nBasicBlockRequests = 0;
+  nBasicBlockBuilds   = 0;
+  nDominatorRequests  = 0;
+  nDominatorBuilds    = 0;
+  nLiveRequests       = 0;
+  nLiveBuilds         = 0;
+}
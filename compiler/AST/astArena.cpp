@@ -0,0 +1,240 @@
+/*
+ * Copyright 2020 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "astArena.h"
+
+#include "driver.h"
+#include "misc.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#include <stdint.h>
+#include <sys/mman.h>
+
+// Slabs are aligned to their size so a node's slab can be found by masking
+static const size_t kSlabSize    = 256 * 1024;
+
+// Nodes are grouped into sizes in steps of kGranule; bigger ones use malloc
+static const size_t kGranule     = 16;
+static const size_t kMaxNodeSize = 1024;
+static const int    kNumClasses  = kMaxNodeSize / kGranule + 1;
+
+class ArenaSlab {
+public:
+  int       sizeClass;
+  int       numLive;
+};
+
+// Slots are carved out after the slab header
+static const size_t kSlabHeader  = (sizeof(ArenaSlab) + kGranule - 1) /
+                                   kGranule * kGranule;
+
+class FreeSlot {
+public:
+  FreeSlot* next;
+};
+
+class ArenaClass {
+public:
+  FreeSlot*               freeList;
+  char*                   bump;       // next unused slot in the newest slab
+  char*                   limit;
+  std::vector<ArenaSlab*> slabs;
+};
+
+static ArenaClass sClasses[kNumClasses];
+
+static size_t     sMappedBytes = 0;
+static size_t     sLiveBytes   = 0;
+
+
+static ArenaSlab* slabOf(void* ptr) {
+  return (ArenaSlab*) ((uintptr_t) ptr & ~(uintptr_t) (kSlabSize - 1));
+}
+
+// Map twice the size needed and trim it down to an aligned slab
+static ArenaSlab* mapSlab(int sizeClass) {
+  size_t mapSize = 2 * kSlabSize;
+  void*  mapped  = mmap(NULL, mapSize, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANON, -1, 0);
+
+  if (mapped == MAP_FAILED) {
+    INT_FATAL("out of memory allocating AST nodes");
+  }
+
+  char* start   = (char*) mapped;
+  char* aligned = (char*) (((uintptr_t) start + kSlabSize - 1) &
+                           ~(uintptr_t) (kSlabSize - 1));
+  char* end     = start + mapSize;
+
+  if (aligned > start)
+    munmap(start, aligned - start);
+
+  if (aligned + kSlabSize < end)
+    munmap(aligned + kSlabSize, end - (aligned + kSlabSize));
+
+  ArenaSlab* slab = (ArenaSlab*) aligned;
+
+  slab->sizeClass = sizeClass;
+  slab->numLive   = 0;
+
+  sMappedBytes += kSlabSize;
+
+  return slab;
+}
+
+static void unmapSlab(ArenaSlab* slab) {
+  munmap(slab, kSlabSize);
+
+  sMappedBytes -= kSlabSize;
+}
+
+void* astArenaAllocate(size_t size) {
+  if (size > kMaxNodeSize) {
+    void* retval = malloc(size);
+
+    if (retval == NULL) {
+      INT_FATAL("out of memory allocating AST nodes");
+    }
+
+    return retval;
+  }
+
+  int         sizeClass = (size + kGranule - 1) / kGranule;
+  size_t      slotSize  = sizeClass * kGranule;
+  ArenaClass& arena     = sClasses[sizeClass];
+  void*       retval    = NULL;
+
+  if (arena.freeList != NULL) {
+    retval         = arena.freeList;
+    arena.freeList = arena.freeList->next;
+
+  } else {
+    if (arena.bump == NULL || arena.bump + slotSize > arena.limit) {
+      ArenaSlab* slab = mapSlab(sizeClass);
+
+      arena.slabs.push_back(slab);
+
+      arena.bump  = (char*) slab + kSlabHeader;
+      arena.limit = (char*) slab + kSlabSize;
+    }
+
+    retval     = arena.bump;
+    arena.bump = arena.bump + slotSize;
+  }
+
+  slabOf(retval)->numLive++;
+
+  sLiveBytes += slotSize;
+
+  return retval;
+}
+
+void astArenaFree(void* ptr, size_t size) {
+  if (ptr == NULL) {
+    return;
+
+  } else if (size > kMaxNodeSize) {
+    free(ptr);
+
+  } else {
+    int         sizeClass = (size + kGranule - 1) / kGranule;
+    ArenaClass& arena     = sClasses[sizeClass];
+    FreeSlot*   slot      = (FreeSlot*) ptr;
+
+    INT_ASSERT(slabOf(ptr)->sizeClass == sizeClass);
+
+    slot->next     = arena.freeList;
+    arena.freeList = slot;
+
+    slabOf(ptr)->numLive--;
+
+    sLiveBytes -= sizeClass * kGranule;
+  }
+}
+
+//
+// Drop the free slots that lie in empty slabs, unmap those slabs, and
+// rebuild the rest of the free list in address order.  The newest slab is
+// kept even if it is empty, and simply starts over from its first slot.
+//
+static void compactClass(ArenaClass& arena) {
+  ArenaSlab*              newest = NULL;
+  std::vector<FreeSlot*>  slots;
+  std::vector<ArenaSlab*> slabs;
+
+  if (arena.slabs.size() > 0) {
+    newest = arena.slabs.back();
+  }
+
+  // An empty newest slab is reused from its start, so none of the slots
+  // in empty slabs stay on the free list
+  for (FreeSlot* slot = arena.freeList; slot != NULL; slot = slot->next) {
+    if (slabOf(slot)->numLive > 0) {
+      slots.push_back(slot);
+    }
+  }
+
+  for (size_t i = 0; i < arena.slabs.size(); i++) {
+    ArenaSlab* slab = arena.slabs[i];
+
+    if (slab->numLive > 0) {
+      slabs.push_back(slab);
+
+    } else if (slab == newest) {
+      slabs.push_back(slab);
+
+      arena.bump = (char*) slab + kSlabHeader;
+
+    } else {
+      unmapSlab(slab);
+    }
+  }
+
+  std::sort(slots.begin(), slots.end());
+
+  arena.freeList = NULL;
+
+  for (size_t i = slots.size(); i > 0; i--) {
+    slots[i - 1]->next = arena.freeList;
+    arena.freeList     = slots[i - 1];
+  }
+
+  arena.slabs.swap(slabs);
+}
+
+void astArenaCompact(const char* passName) {
+  size_t mappedBefore = sMappedBytes;
+
+  for (int i = 0; i < kNumClasses; i++) {
+    compactClass(sClasses[i]);
+  }
+
+  if (fPrintStatistics[0] != '\0') {
+    fprintf(stderr,
+            "%7d KiB of AST nodes in %d KiB of slabs, %d KiB released (%s)\n",
+            (int) (sLiveBytes / 1024),
+            (int) (sMappedBytes / 1024),
+            (int) ((mappedBefore - sMappedBytes) / 1024),
+            passName);
+  }
+}
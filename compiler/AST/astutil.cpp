@@ -654,6 +654,8 @@ void insert_help(BaseAST* ast,
         symbol->addSymExpr(se);
       }
     }
+    if (FnSymbol* fn = toFnSymbol(parentSymbol))
+      fn->bodyVersion++;
     expr->parentSymbol = parentSymbol;
     expr->parentExpr = parentExpr;
     parentExpr = expr;
@@ -674,6 +676,8 @@ void remove_help(BaseAST* ast, int trace_flag) {
         symbol->removeSymExpr(se);
       }
     }
+    if (FnSymbol* fn = toFnSymbol(expr->parentSymbol))
+      fn->bodyVersion++;
     expr->parentSymbol = NULL;
     expr->parentExpr = NULL;
   } else if (LabelSymbol* labsym = toLabelSymbol(ast)) {
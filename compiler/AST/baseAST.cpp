@@ -20,6 +20,7 @@
 
 #include "baseAST.h"
 
+#include "astArena.h"
 #include "astutil.h"
 #include "CForLoop.h"
 #include "CatchStmt.h"
@@ -339,6 +340,14 @@ static void checkid(int id) {
 }
 
 
+void* BaseAST::operator new(size_t size) {
+  return astArenaAllocate(size);
+}
+
+void BaseAST::operator delete(void* ptr, size_t size) {
+  astArenaFree(ptr, size);
+}
+
 BaseAST::BaseAST(AstTag type) :
   astTag(type),
   id(uid++),
@@ -20,6 +20,7 @@
 
 #include "bb.h"
 
+#include "analysisManager.h"
 #include "astutil.h"
 #include "bitVec.h"
 #include "CForLoop.h"
@@ -34,10 +35,10 @@
 #include <queue>
 
 
-int                                          BasicBlock::nextID     = 0;
-BasicBlock*                                  BasicBlock::basicBlock = NULL;
-Map<LabelSymbol*, std::vector<BasicBlock*>*> BasicBlock::gotoMaps;
-Map<LabelSymbol*, BasicBlock*>               BasicBlock::labelMaps;
+thread_local int                                          BasicBlock::nextID     = 0;
+thread_local BasicBlock*                                  BasicBlock::basicBlock = NULL;
+thread_local Map<LabelSymbol*, std::vector<BasicBlock*>*> BasicBlock::gotoMaps;
+thread_local Map<LabelSymbol*, BasicBlock*>               BasicBlock::labelMaps;
 
 BasicBlock::BasicBlock() {
   id = nextID++;
@@ -56,6 +57,10 @@ void BasicBlock::reset(FnSymbol* fn) {
 }
 
 void BasicBlock::clear(FnSymbol* fn) {
+  // The cached analyses are derived from the blocks
+  delete fn->analyses;
+  fn->analyses = NULL;
+
   if (fn->basicBlocks != NULL) {
     for_vector(BasicBlock, bb, *fn->basicBlocks)
       delete bb;
@@ -1177,6 +1177,118 @@ static void removeWrappingBlock(BlockStmt*& block) {
         block = (BlockStmt*)nested->remove();
 }
 
+// Is this 'coforall idx in iterator do on idx { ... }' in user code,
+// where the on-statement is the whole body and targets the index?
+static bool isCoforallOnIndex(Expr* indices,
+                              CallExpr* byref_vars,
+                              BlockStmt* body,
+                              bool zippered) {
+  if (zippered || byref_vars || currentModuleType != MOD_USER)
+    return false;
+
+  UnresolvedSymExpr* index = toUnresolvedSymExpr(indices);
+  BlockStmt* onBlock = findStmtWithTag(PRIM_BLOCK_ON, body);
+
+  if (index == NULL || onBlock == NULL)
+    return false;
+
+  // buildOnStmt() evaluates the target just before the on-block as
+  //   move tmp, deref(wide_get_locale(target))
+  SymExpr* tmpSe = toSymExpr(onBlock->blockInfoGet()->get(2));
+  CallExpr* move = toCallExpr(onBlock->prev);
+
+  if (tmpSe == NULL || move == NULL || !move->isPrimitive(PRIM_MOVE))
+    return false;
+
+  SymExpr* lhs = toSymExpr(move->get(1));
+  CallExpr* deref = toCallExpr(move->get(2));
+
+  if (lhs == NULL || lhs->symbol() != tmpSe->symbol() ||
+      deref == NULL || !deref->isPrimitive(PRIM_DEREF))
+    return false;
+
+  CallExpr* getLocale = toCallExpr(deref->get(1));
+
+  if (getLocale == NULL || !getLocale->isPrimitive(PRIM_WIDE_GET_LOCALE))
+    return false;
+
+  UnresolvedSymExpr* target = toUnresolvedSymExpr(getLocale->get(1));
+
+  return target != NULL && strcmp(target->unresolved, index->unresolved) == 0;
+}
+
+// Build the tree-structured launch of 'coforall idx in tmpIter do on idx'
+// over an array of locales (see chpl__coforallOnTreeOk()):
+//
+//     proc _coforallOnTree(lo: int, hi: int) throws {
+//       cobegin {
+//         coforall child in chpl__coforallOnTreeChildren(lo, hi) do
+//           on chpl__coforallOnTreeElem(tmpIter, child(0)) do
+//             _coforallOnTree(child(0), child(1));
+//         { const idx = chpl__coforallOnTreeElem(tmpIter, lo); body(); }
+//       }
+//     }
+//     on chpl__coforallOnTreeElem(tmpIter, 0) do
+//       _coforallOnTree(0, tmpIter.size);
+//
+// The on-statement in body() targets the locale the task is already
+// running on, so it does not fork again.  Errors are gathered by the
+// nested cobegins and coforalls and flattened by TaskErrors, as for the
+// flat launch; the function is "unchecked throws" like _waitEndCount.
+static BlockStmt* buildCoforallOnTree(const char* index,
+                                      VarSymbol* iterator,
+                                      BlockStmt* body) {
+  FnSymbol* fn = new FnSymbol("_coforallOnTree");
+  ArgSymbol* lo = new ArgSymbol(INTENT_BLANK, "lo", dtInt[INT_SIZE_DEFAULT]);
+  ArgSymbol* hi = new ArgSymbol(INTENT_BLANK, "hi", dtInt[INT_SIZE_DEFAULT]);
+
+  fn->insertFormalAtTail(lo);
+  fn->insertFormalAtTail(hi);
+  fn->retType = dtVoid;
+  fn->throwsErrorInit();
+  fn->addFlag(FLAG_UNCHECKED_THROWS);
+
+  const char* child = "_coforallOnTreeChild";
+  CallExpr* recurse = new CallExpr(fn,
+                                   new CallExpr(child, new_IntSymbol(0)),
+                                   new CallExpr(child, new_IntSymbol(1)));
+  Expr* childLocale = new CallExpr("chpl__coforallOnTreeElem", iterator,
+                                   new CallExpr(child, new_IntSymbol(0)));
+  BlockStmt* children =
+    buildCoforallLoopStmt(new UnresolvedSymExpr(child),
+                          new CallExpr("chpl__coforallOnTreeChildren", lo, hi),
+                          NULL,
+                          new BlockStmt(buildOnStmt(childLocale,
+                                                    new BlockStmt(recurse))),
+                          false);
+
+  VarSymbol* indexVar = new VarSymbol(index);
+  indexVar->addFlag(FLAG_CONST);
+
+  BlockStmt* leaf = new BlockStmt();
+  leaf->insertAtTail(new DefExpr(indexVar,
+                                 new CallExpr("chpl__coforallOnTreeElem",
+                                              iterator, lo)));
+  leaf->insertAtTail(body);
+
+  BlockStmt* tasks = new BlockStmt();
+  tasks->insertAtTail(children);
+  tasks->insertAtTail(leaf);
+  fn->insertAtTail(buildCobeginStmt(NULL, tasks));
+
+  VarSymbol* numLocales = newTemp("numLocales");
+  BlockStmt* block = new BlockStmt();
+  block->insertAtTail(new DefExpr(fn));
+  block->insertAtTail(new DefExpr(numLocales));
+  block->insertAtTail(new CallExpr(PRIM_MOVE, numLocales,
+                        new CallExpr(".", iterator, new_CStringSymbol("size"))));
+  block->insertAtTail(buildOnStmt(new CallExpr("chpl__coforallOnTreeElem",
+                                               iterator, new_IntSymbol(0)),
+                                  new BlockStmt(new CallExpr(fn, new_IntSymbol(0),
+                                                             numLocales))));
+  return block;
+}
+
 // Build up AST for coforalls. For something like:
 //
 //     coforall indices in iterator with (byref_vars) { body(); }
@@ -1246,6 +1358,17 @@ BlockStmt* buildCoforallLoopStmt(Expr* indices,
   coforallBlk->insertAtTail(new DefExpr(tmpIter));
   coforallBlk->insertAtTail(new CallExpr(PRIM_MOVE, tmpIter, iterator));
 
+  // Over a large enough array of locales, launch 'coforall loc in A do
+  // on loc' as a tree; otherwise fall back to the flat bounded launch.
+  BlockStmt* treeCoforallBlk = NULL;
+  if (isCoforallOnIndex(indices, byref_vars, body, zippered)) {
+    BlockStmt* treeBlk = buildCoforallOnTree(toUnresolvedSymExpr(indices)->unresolved,
+                                             tmpIter, body->copy());
+    BlockStmt* flatBlk = buildLoweredCoforall(indices->copy(), tmpIter, NULL, body->copy(), zippered, /*bounded=*/true);
+    treeCoforallBlk = buildIfStmt(new CallExpr("chpl__coforallOnTreeUse", tmpIter),
+                                  treeBlk, flatBlk);
+  }
+
   BlockStmt* vectorCoforallBlk = buildLoweredCoforall(indices, tmpIter, copyByrefVars(byref_vars), body->copy(), zippered, /*bounded=*/true);
   BlockStmt* nonVectorCoforallBlk = buildLoweredCoforall(indices, tmpIter, byref_vars, body, zippered, /*bounded=*/false);
 
@@ -1257,9 +1380,22 @@ BlockStmt* buildCoforallLoopStmt(Expr* indices,
                             new CallExpr("||", new CallExpr("isBoundedRange", tmpIter),
                             new CallExpr("||", new CallExpr("isDomain", tmpIter), new CallExpr("isArray", tmpIter)))));
 
-  coforallBlk->insertAtTail(new CondStmt(new SymExpr(isRngDomArr),
-                                         vectorCoforallBlk,
-                                         nonVectorCoforallBlk));
+  CondStmt* loweredCoforall = new CondStmt(new SymExpr(isRngDomArr),
+                                           vectorCoforallBlk,
+                                           nonVectorCoforallBlk);
+
+  if (treeCoforallBlk) {
+    VarSymbol* isTree = newTemp("isCoforallOnTree");
+    isTree->addFlag(FLAG_MAYBE_PARAM);
+    coforallBlk->insertAtTail(new DefExpr(isTree));
+    coforallBlk->insertAtTail(new CallExpr(PRIM_MOVE, isTree,
+                              new CallExpr("chpl__coforallOnTreeOk", tmpIter)));
+    coforallBlk->insertAtTail(new CondStmt(new SymExpr(isTree),
+                                           treeCoforallBlk,
+                                           loweredCoforall));
+  } else {
+    coforallBlk->insertAtTail(loweredCoforall);
+  }
   return coforallBlk;
 }
 
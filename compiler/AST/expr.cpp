@@ -651,6 +651,10 @@ void SymExpr::setSymbol(Symbol* s)
   }
   // Update the symbol
   var = s;
+  // Analyses cached for the enclosing function are now out of date
+  if (FnSymbol* fn = toFnSymbol(parentSymbol)) {
+    fn->bodyVersion++;
+  }
   // If the symbol is not NULL and the SymExpr is in the tree,
   // add the SymExpr to the new Symbol's list.
   if (s != NULL && parentSymbol != NULL) {
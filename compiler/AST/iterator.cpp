@@ -20,6 +20,7 @@
 
 #include "iterator.h"
 
+#include "analysisManager.h"
 #include "astutil.h"
 #include "bb.h"
 #include "bitVec.h"
@@ -1524,13 +1525,12 @@ buildIncr(IteratorInfo* ii, BlockStmt* singleLoop) {
 // Collect local variables that are live at the point of any yield.
 static void collectLiveLocalVariables(Vec<Symbol*>& syms, FnSymbol* fn, BlockStmt* singleLoop)
 {
-  Vec<Symbol*> locals;
-  Map<Symbol*,int> localMap;
-  Vec<SymExpr*> useSet;
-  Vec<SymExpr*> defSet;
-  std::vector<BitVec*> OUT;
-
-  liveVariableAnalysis(fn, locals, localMap, useSet, defSet, OUT);
+  LiveVariables&        liveVariables = getLiveVariables(fn);
+  Vec<Symbol*>&         locals        = liveVariables.locals;
+  Map<Symbol*,int>&     localMap      = liveVariables.localMap;
+  Vec<SymExpr*>&        useSet        = liveVariables.useSet;
+  Vec<SymExpr*>&        defSet        = liveVariables.defSet;
+  std::vector<BitVec*>& OUT           = liveVariables.OUT;
 
   int block = 0;
 
@@ -1587,9 +1587,6 @@ static void collectLiveLocalVariables(Vec<Symbol*>& syms, FnSymbol* fn, BlockStm
     block++;
   }
 
-  for_vector(BitVec, out, OUT)
-    delete out;
-
   // C_FOR_LOOP needs to ensure the for-loop init variables are also
   // converted to fields.  The test/incr fields are handled correctly
   // as a result of being inserted in to the body of the loop
@@ -1707,7 +1704,7 @@ static void
 addLiveLocalVariables(Vec<Symbol*>& syms, FnSymbol* fn, BlockStmt* singleLoop,
                       Vec<Symbol*>& yldSymSet)
 {
-  BasicBlock::buildBasicBlocks(fn);
+  getBasicBlocks(fn);
 
 #ifdef DEBUG_LIVE
   printf("Iterator\n");
@@ -1361,6 +1361,69 @@ static void genGlobalSerializeTable(GenInfo* info) {
   }
 }
 
+//
+// Under --profile-gen every generated function counts its calls in
+// chpl_fnProfileCounts, and the runtime writes the counts out along
+// with the function ids and names when the program exits (see
+// runtime/include/chpl-fn-profile.h).  The tables are always generated
+// so that the runtime can refer to them.
+//
+static std::map<FnSymbol*, int> fnProfileIndices;
+
+int fnProfileIndex(FnSymbol* fn) {
+  std::map<FnSymbol*, int>::iterator it = fnProfileIndices.find(fn);
+
+  return it != fnProfileIndices.end() ? it->second : -1;
+}
+
+static void genFnProfileTables(FILE* outfile,
+                               std::vector<FnSymbol*>& functions) {
+  std::vector<FnSymbol*> profiled;
+
+  if (fProfileGen[0] != '\0') {
+    for_vector(FnSymbol, fn, functions) {
+      if (!fn->hasFlag(FLAG_EXTERN) && !fn->hasFlag(FLAG_NO_CODEGEN)) {
+        fnProfileIndices[fn] = profiled.size();
+        profiled.push_back(fn);
+      }
+    }
+  }
+
+  fprintf(outfile, "\nint64_t chpl_fnProfileCounts[%d];\n",
+          profiled.size() > 0 ? (int) profiled.size() : 1);
+
+  fprintf(outfile, "const int32_t chpl_fnProfileIds[] = {\n");
+  if (profiled.size() == 0) {
+    fprintf(outfile, "0");
+  } else {
+    for (size_t i = 0; i < profiled.size(); i++) {
+      fprintf(outfile, "%s%d", i > 0 ? ",\n" : "", profiled[i]->id);
+    }
+  }
+  fprintf(outfile, "\n};\n");
+
+  fprintf(outfile, "const char* chpl_fnProfileNames[] = {\n");
+  if (profiled.size() == 0) {
+    fprintf(outfile, "NULL");
+  } else {
+    for (size_t i = 0; i < profiled.size(); i++) {
+      fprintf(outfile, "%s\"%s\"", i > 0 ? ",\n" : "", profiled[i]->name);
+    }
+  }
+  fprintf(outfile, "\n};\n");
+
+  fprintf(outfile, "const int32_t chpl_fnProfileNumFns = %d;\n",
+          (int) profiled.size());
+
+  fprintf(outfile, "const char* chpl_fnProfileFile = \"");
+  for (const char* c = fProfileGen; *c != '\0'; c++) {
+    if (*c == '"' || *c == '\\')
+      fputc('\\', outfile);
+    fputc(*c, outfile);
+  }
+  fprintf(outfile, "\";\n");
+}
+
 // TODO: Split this into a number of smaller routines.<hilde>
 static void codegen_defn(std::set<const char*> & cnames, std::vector<TypeSymbol*> & types,
   std::vector<FnSymbol*> & functions, std::vector<VarSymbol*> & globals) {
@@ -1418,6 +1481,7 @@ static void codegen_defn(std::set<const char*> & cnames, std::vector<TypeSymbol*
       }
     }
     fprintf(hdrfile, "\n};\n");
+    genFnProfileTables(hdrfile, functions);
   }
 
   genGlobalInt("chpl_mem_numDescs", memDescsVec.n, false);
@@ -2343,15 +2407,11 @@ void codegen() {
       forv_Vec(ModuleSymbol, currentModule, allModules) {
         const char* filename = NULL;
         filename = generateFileName(fileNameHashMap, filename, currentModule->name);
+        // The Makefile names each object after its source minus ".c".
+        // Don't create the source here: truncating it would defeat the
+        // up-to-date checks when the intermediate directory is reused.
         if(currentModule->modTag == MOD_USER) {
-          fileinfo modulefile;
-          openCFile(&modulefile, filename, "c");
-          int modulePathLen = strlen(astr(modulefile.pathname));
-          char path[FILENAME_MAX];
-          strncpy(path, astr(modulefile.pathname), modulePathLen-2);
-          path[modulePathLen-2]='\0';
-          userFileName.push_back(astr(path));
-          closeCFile(&modulefile);
+          userFileName.push_back(genIntermediateFilename(filename));
         }
       }
     }
@@ -2450,7 +2510,7 @@ void makeBinary(void) {
 #endif
   } else {
     const char* makeflags = printSystemCommands ? "-f " : "-s -f ";
-    const char* command = astr(astr(CHPL_MAKE, " "),
+    const char* command = astr(astr(CHPL_MAKE, " -j", istr(fBackendJobs), " "),
                                makeflags,
                                getIntermediateDirName(), "/Makefile");
     mysystem(command, "compiling generated source");
@@ -1764,6 +1764,9 @@ void FnSymbol::codegenHeaderC(void) {
   if (!fIncrementalCompilation && !hasFlag(FLAG_EXPORT) && !hasFlag(FLAG_EXTERN)) {
     fprintf(outfile, "static ");
   }
+  if (hasFlag(FLAG_COLD_FN)) {
+    fprintf(outfile, "CHPL_COLD_FN ");
+  }
   fprintf(outfile, "%s", codegenFunctionType(true).c.c_str());
 }
 
@@ -1926,6 +1929,11 @@ void FnSymbol::codegenDef() {
     if (fNoInline)
       func->addFnAttr(llvm::Attribute::NoInline);
 
+    if (this->hasFlag(FLAG_COLD_FN)) {
+      func->addFnAttr(llvm::Attribute::Cold);
+      func->addFnAttr(llvm::Attribute::NoInline);
+    }
+
     if (this->hasFlag(FLAG_LLVM_READNONE))
       func->addFnAttr(llvm::Attribute::ReadNone);
 
@@ -2007,6 +2015,19 @@ void FnSymbol::codegenDef() {
     }
   }
 
+  int profileIndex = fnProfileIndex(this);
+
+  if (profileIndex >= 0) {
+    GenRet count = codegenCallExpr("chpl_fnProfileCount",
+                                   new_IntSymbol(profileIndex,
+                                                 INT_SIZE_32)->codegen());
+
+    if (outfile)
+      info->cStatements.push_back(count.c + ";\n");
+
+    flushStatements();
+  }
+
   body->codegen();
   flushStatements();
 #ifdef HAVE_LLVM
@@ -24,6 +24,7 @@
 #include "library.h"
 #include "symbol.h"
 
+class FnAnalyses;
 class IteratorGroup;
 
 enum RetTag {
@@ -74,6 +75,13 @@ private:
 
 public:
   std::vector<BasicBlock*>*  basicBlocks;
+
+  // Bumped by every edit of the body, so that analyses cached for it
+  // (basicBlocks and analyses, see analysisManager.h) can be reused
+  // as long as it is unchanged
+  unsigned int               bodyVersion;
+  FnAnalyses*                analyses;
+
   Vec<CallExpr*>*            calledBy;
   const char*                userString;
 
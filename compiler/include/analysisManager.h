@@ -0,0 +1,90 @@
+/*
+ * Copyright 2020 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ANALYSIS_MANAGER_H_
+#define _ANALYSIS_MANAGER_H_
+
+#include "map.h"
+#include "vec.h"
+
+#include <vector>
+
+class BasicBlock;
+class BitVec;
+class FnSymbol;
+class SymExpr;
+class Symbol;
+
+//
+// Caches the basic blocks, dominators and live variables of each function
+// so that passes analyzing a function that has not changed since it was
+// last analyzed reuse the earlier results instead of recomputing them.
+//
+// Every edit of a function's body bumps fn->bodyVersion (see insert_help,
+// remove_help and SymExpr::setSymbol); the cached analyses of a function
+// are only used while its bodyVersion matches the one they were computed
+// for.  The analyses also depend on the types and flags of the symbols a
+// body refers to, which a pass may change without editing the body, so
+// runPasses() frees all of them after each pass that is not known to only
+// edit function bodies.
+//
+// The results belong to the cache and must not be modified or freed.
+// Different functions may be analyzed concurrently (see
+// forEachFnConcurrently), but one function must not be analyzed by two
+// threads at once.
+//
+
+class LiveVariables {
+public:
+  Vec<Symbol*>         locals;    // the local variables of the function
+  Map<Symbol*, int>    localMap;  // the index of each one in locals
+  Vec<SymExpr*>        useSet;    // SymExprs that use a local
+  Vec<SymExpr*>        defSet;    // SymExprs that define a local
+
+  // OUT[i] is the set of locals live at the exit of basic block i
+  std::vector<BitVec*> OUT;
+};
+
+class FnAnalyses {
+public:
+                       FnAnalyses();
+                      ~FnAnalyses();
+
+  // fn->bodyVersion when fn->basicBlocks was built
+  unsigned int         version;
+
+  // dominators[i] is the set of blocks dominating block i, if computed
+  std::vector<BitVec*> dominators;
+
+  LiveVariables*       live;
+};
+
+// Makes fn->basicBlocks current and returns it
+std::vector<BasicBlock*>& getBasicBlocks(FnSymbol* fn);
+
+std::vector<BitVec*>&     getDominators(FnSymbol* fn);
+
+LiveVariables&            getLiveVariables(FnSymbol* fn);
+
+void                      freeAnalyses(FnSymbol* fn);
+
+void                      freeAllAnalyses(const char* passName);
+
+#endif
@@ -0,0 +1,41 @@
+/*
+ * Copyright 2020 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _AST_ARENA_H_
+#define _AST_ARENA_H_
+
+#include <cstddef>
+
+//
+// BaseAST nodes are carved out of large slabs, one size of node per slab,
+// rather than being malloc'ed one at a time.  Freed nodes go on a free
+// list for their size and are reused by later allocations.
+//
+// astArenaCompact() gives slabs whose nodes have all been deleted back to
+// the operating system and sorts the free lists by address so that new
+// nodes are packed densely.  It is run after cleanAst() has deleted the
+// nodes removed by prune and prune2.
+//
+void* astArenaAllocate(size_t size);
+void  astArenaFree(void* ptr, size_t size);
+
+void  astArenaCompact(const char* passName);
+
+#endif
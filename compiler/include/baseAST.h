@@ -269,6 +269,10 @@ public:
 
   static  const       std::string tabText;
 
+  // Nodes are allocated from the AST arena, see astArena.h
+  static void*        operator new   (size_t size);
+  static void         operator delete(void* ptr, size_t size);
+
 protected:
                     BaseAST(AstTag type);
   virtual          ~BaseAST();
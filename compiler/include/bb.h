@@ -36,6 +36,8 @@ class SymExpr;
 
 // Each basic block contains a list of expressions, in and out edges and an index.
 // The goto and label maps persist only between calls to buildBasicBlocks.
+// The builder's state is per thread, so that blocks for different functions
+// can be built concurrently (see forEachFnConcurrently).
 class BasicBlock
 {
   //
@@ -102,9 +104,9 @@ public:
   static void        printBitVectorSets(BitVecVector& sets);
 
 
-  static BasicBlock*                          basicBlock;
-  static Map<LabelSymbol*, BasicBlock*>       labelMaps;
-  static Map<LabelSymbol*, BasicBlockVector*> gotoMaps;
+  static thread_local BasicBlock*                          basicBlock;
+  static thread_local Map<LabelSymbol*, BasicBlock*>       labelMaps;
+  static thread_local Map<LabelSymbol*, BasicBlockVector*> gotoMaps;
 
 private:
   static void        buildBasicBlocks(FnSymbol* fn,
@@ -121,7 +123,7 @@ private:
   static void        removeEmptyBlocks(FnSymbol* fn);
   static bool        verifyBasicBlocks(FnSymbol* fn);
 
-  static int         nextID;
+  static thread_local int nextID;
 
   //
   // Instance methods/variables
@@ -162,6 +162,9 @@ GenRet codegenCallExpr(const char* fnName);
 GenRet codegenCallExpr(const char* fnName, GenRet a1);
 GenRet codegenCallExpr(const char* fnName, GenRet a1, GenRet a2);
 
+// The index of fn's call counter under --profile-gen, or -1
+int fnProfileIndex(FnSymbol* fn);
+
 void registerPrimitiveCodegens();
 
 #endif //CODEGEN_H
@@ -0,0 +1,46 @@
+/*
+ * Copyright 2020 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _COMPILE_CACHE_H_
+#define _COMPILE_CACHE_H_
+
+#include <cstdio>
+
+struct ArgumentDescription;
+
+//
+// A persistent, content-hashed cache of compiler results.  The key
+// covers the compiler binary, the command line, the CHPL_* settings,
+// the runtime libraries and the contents of every module file that was
+// parsed, so a hit is only possible when recompiling exactly the same
+// program in exactly the same configuration.
+//
+extern char compileCacheDir[FILENAME_MAX+1];
+
+void initCompileCache(const char*                compilerPath,
+                      const ArgumentDescription* argDesc);
+
+// Called after parsing; does not return if a cached result was used.
+void compileCacheLookup();
+
+// Called once the executable has been built.
+void compileCacheStore();
+
+#endif
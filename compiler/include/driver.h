@@ -37,6 +37,7 @@ extern bool fFastFlag;
 extern bool fNoBoundsChecks;
 extern bool fNoCopyPropagation;
 extern bool fNoDeadCodeElimination;
+extern bool fNoDevirtualize;
 extern bool fNoGlobalConstOpt;
 extern bool fNoFastFollowers;
 extern bool fNoInlineIterators;
@@ -61,6 +62,7 @@ extern bool fNoInferConstRefs;
 extern bool fNoRemoteSerialization;
 extern bool fNoRemoveCopyCalls;
 extern bool fNoScalarReplacement;
+extern bool fNoStackAllocateClasses;
 extern bool fNoTupleCopyOpt;
 extern bool fNoOptimizeRangeIteration;
 extern bool fNoOptimizeLoopIterators;
@@ -79,6 +81,7 @@ extern int  tuple_copy_limit;
 
 extern bool fNoOptimizeForallUnordered;
 extern bool fReportOptimizeForallUnordered;
+extern bool fAutoAggregation;
 
 extern bool report_inlining;
 
@@ -127,6 +130,7 @@ extern const char* CHPL_LLVM_UNIQ_CFG_PATH;
 
 extern bool  printPasses;
 extern FILE* printPassesFile;
+extern FILE* printPassesJsonFile;
 
 extern char fExplainCall[256];
 extern int  explainCallID;
@@ -159,6 +163,12 @@ extern bool fCompileTimeNilChecking;
 extern bool fOverrideChecking;
 extern int  ffloatOpt;
 extern int  fMaxCIdentLen;
+extern int  fBackendJobs;
+extern int  fPassThreads;
+
+// Function call count profiles, see profileGuidedInlining()
+extern char fProfileGen[FILENAME_MAX+1];
+extern char fProfileUse[FILENAME_MAX+1];
 
 extern bool llvmCodegen;
 
@@ -209,10 +219,15 @@ extern bool fReportOptimizedLoopIterators;
 extern bool fReportInlinedIterators;
 extern bool fReportVectorizedLoops;
 extern bool fReportOptimizedOn;
+extern bool fReportAutoAggregation;
 extern bool fReportPromotion;
 extern bool fReportScalarReplace;
+extern bool fReportStackAllocatedClasses;
 extern bool fReportDeadBlocks;
+extern bool fReportDevirtualizedCalls;
 extern bool fReportDeadModules;
+extern bool fReportWideReferences;
+extern bool fReportForwardedFields;
 
 extern bool fPermitUnhandledModuleErrors;
 
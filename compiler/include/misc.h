@@ -111,6 +111,7 @@ void        printCallStack();
 void        printCallStackCalls();
 
 bool        fatalErrorsEncountered();
+bool        warningsEncountered();
 void        clearFatalErrors();
 
 bool printsSameLocationAsLastError(const BaseAST* ast);
@@ -61,6 +61,9 @@ void checkLifetimesForForallUnorderedOps(FnSymbol* fn,
                                          LifetimeInformation* lifetimeInfo);
 void optimizeForallUnorderedOps();
 
+void autoAggregateForalls();
+void reportAutoAggregation();
+
 void liveVariableAnalysis(FnSymbol* fn,
                           Vec<Symbol*>& locals,
                           Map<Symbol*,int>& localID,
@@ -70,6 +73,8 @@ void liveVariableAnalysis(FnSymbol* fn,
 
 void remoteValueForwarding();
 
+void stackAllocateClasses();
+
 void inferConstRefs();
 
 void computeNoAliasSets();
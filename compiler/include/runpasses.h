@@ -21,11 +21,28 @@
 #ifndef _RUN_PASSES_H_
 #define _RUN_PASSES_H_
 
+#include <cstddef>
+#include <vector>
+
+class FnSymbol;
 class PhaseTracker;
 
 void runPasses(PhaseTracker& tracker, bool isChpldoc);
 void initPassesForLogging();
 
+//
+// Calls analyze(fns[i], i, data) for every function in fns, spread
+// over up to --pass-threads threads.  analyze must not modify the AST
+// or any other shared compiler state; it should leave its findings in
+// slot i of data so the pass can apply them, in order, afterwards.
+// That keeps the generated code independent of the thread count.
+//
+void forEachFnConcurrently(std::vector<FnSymbol*>& fns,
+                           void (*analyze)(FnSymbol* fn,
+                                           size_t    i,
+                                           void*     data),
+                           void* data);
+
 extern int currentPassNo;
 
 #endif
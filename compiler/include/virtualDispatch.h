@@ -24,9 +24,18 @@
 #include "map.h"
 #include "vec.h"
 
+#include <map>
+#include <vector>
+
+class AggregateType;
+class CallExpr;
+class Expr;
 class FnSymbol;
 class Type;
 
+// Map a method to the classes for which a virtual call selects it
+typedef std::map<FnSymbol*, std::vector<AggregateType*> > TargetMap;
+
 // Map a method to the set of methods being overridden
 extern Map<FnSymbol*, Vec<FnSymbol*>*> virtualRootsMap;
 
@@ -48,4 +57,15 @@ void resolveDynamicDispatches();
 
 void insertDynamicDispatchCalls();
 
+void computeDispatchTypes();
+
+void clearDispatchTypes();
+
+bool virtualCallTargets(CallExpr*  call,
+                        FnSymbol*  fn,
+                        Expr*      _this,
+                        TargetMap& targets);
+
+void speculativelyDevirtualize(std::map<FnSymbol*, int64_t>& fnCalls);
+
 #endif
@@ -20,13 +20,18 @@
 
 #include "PhaseTracker.h"
 
+#include "AstCount.h"
 #include "baseAST.h"
 #include "driver.h"
+#include "ModuleSymbol.h"
 
 #include <cstdlib>
 #include <cstring>
 #include <algorithm>
 
+#include <sys/resource.h>
+#include <unistd.h>
+
 // Used to collect the times as the program runs
 class Phase
 {
@@ -85,6 +90,38 @@ public:
   unsigned long  mCleanAst;         // usecs()
 };
 
+// The CPU time and memory used by the compiler at some point
+class ResourceSample
+{
+public:
+                 ResourceSample();
+
+  void           Take();
+
+  unsigned long  mCpuUsecs;         // user + system
+  long           mRssKiB;           // -1 if not known on this platform
+  long           mPeakRssKiB;
+};
+
+// What --print-passes-json reports for one pass, in addition to its times
+class PassSample
+{
+public:
+                 PassSample(const char* name, int passId);
+                ~PassSample();
+
+  char*          mName;
+  int            mPassId;
+  bool           mDone;
+
+  ResourceSample mStart;
+  ResourceSample mEnd;
+
+  AstCount       mCounts;
+  int            mNumFnSymbols;
+  int            mNumTypeSymbols;
+};
+
 struct SortByTime
 {
   bool operator() (Pass const& a, Pass const& b) const
@@ -120,6 +157,9 @@ PhaseTracker::~PhaseTracker()
 {
   for (size_t i = 0; i < mPhases.size(); i++)
     delete mPhases[i];
+
+  for (size_t i = 0; i < mSamples.size(); i++)
+    delete mSamples[i];
 }
 
 void PhaseTracker::StartPhase(const char* name)
@@ -144,6 +184,15 @@ void PhaseTracker::StartPhase(const char* name,
   Phase* phase = new Phase(name, passId, subPhase, mTimer.elapsedUsecs());
 
   mPhases.push_back(phase);
+
+  if (printPassesJsonFile != 0 && passId > 0 && subPhase == kPrimary)
+  {
+    PassSample* sample = new PassSample(name, passId);
+
+    sample->mStart.Take();
+
+    mSamples.push_back(sample);
+  }
 }
 
 void PhaseTracker::Stop()
@@ -151,6 +200,28 @@ void PhaseTracker::Stop()
   mTimer.stop();
 }
 
+// Called at the end of each pass, after the AST has been cleaned.
+// Counting the AST takes a while so the timer is paused meanwhile.
+void PhaseTracker::SamplePass()
+{
+  if (mSamples.size() > 0 && mSamples.back()->mDone == false)
+  {
+    PassSample* sample = mSamples.back();
+
+    sample->mEnd.Take();
+
+    mTimer.stop();
+
+    rootModule->accept(&sample->mCounts);
+
+    sample->mNumFnSymbols   = gFnSymbols.n;
+    sample->mNumTypeSymbols = gTypeSymbols.n;
+    sample->mDone           = true;
+
+    mTimer.start();
+  }
+}
+
 void PhaseTracker::ReportPass() const
 {
   int index = mPhases.size() - 1;
@@ -228,6 +299,84 @@ void PhaseTracker::PassesCollect(std::vector<Pass>& passes) const
   }
 }
 
+void PhaseTracker::ReportJson(FILE* fp) const
+{
+  std::vector<Pass> passes;
+  unsigned long     totalTime = mTimer.elapsedUsecs();
+  bool              first     = true;
+
+  PassesCollect(passes);
+
+  fprintf(fp, "{\n");
+  fprintf(fp, "  \"totalSecs\": %.6f,\n", totalTime / 1e6);
+  fprintf(fp, "  \"passes\": [");
+
+  for (size_t i = 0; i < mSamples.size(); i++)
+  {
+    const PassSample* sample = mSamples[i];
+    const Pass*       pass   = NULL;
+
+    if (sample->mDone == false)
+      continue;
+
+    for (size_t j = 0; j < passes.size() && pass == NULL; j++)
+    {
+      if (passes[j].mPassId == sample->mPassId)
+        pass = &passes[j];
+    }
+
+    INT_ASSERT(pass != NULL);
+
+    fprintf(fp, "%s\n    {\n", first ? "" : ",");
+    first = false;
+
+    fprintf(fp, "      \"id\": %d,\n", sample->mPassId);
+    fprintf(fp, "      \"name\": \"%s\",\n", sample->mName);
+    fprintf(fp, "      \"wallSecs\": %.6f,\n", pass->TotalTime() / 1e6);
+    fprintf(fp, "      \"mainSecs\": %.6f,\n", pass->mPrimary  / 1e6);
+    fprintf(fp, "      \"checkSecs\": %.6f,\n", pass->mVerify   / 1e6);
+    fprintf(fp, "      \"cleanSecs\": %.6f,\n", pass->mCleanAst / 1e6);
+    fprintf(fp, "      \"cpuSecs\": %.6f,\n",
+            (sample->mEnd.mCpuUsecs - sample->mStart.mCpuUsecs) / 1e6);
+
+    if (sample->mEnd.mRssKiB >= 0)
+    {
+      fprintf(fp, "      \"rssKiB\": %ld,\n", sample->mEnd.mRssKiB);
+      fprintf(fp, "      \"rssDeltaKiB\": %ld,\n",
+              sample->mEnd.mRssKiB - sample->mStart.mRssKiB);
+    }
+    else
+    {
+      fprintf(fp, "      \"rssKiB\": null,\n");
+      fprintf(fp, "      \"rssDeltaKiB\": null,\n");
+    }
+
+    fprintf(fp, "      \"peakRssKiB\": %ld,\n", sample->mEnd.mPeakRssKiB);
+    fprintf(fp, "      \"fnSymbols\": %d,\n", sample->mNumFnSymbols);
+    fprintf(fp, "      \"typeSymbols\": %d,\n", sample->mNumTypeSymbols);
+
+    fprintf(fp, "      \"astCounts\": {\n");
+
+#define print_count(type)                                               \
+    fprintf(fp, "        \"%s\": %d,\n", #type, sample->mCounts.num##type)
+
+    foreach_ast(print_count);
+
+#undef print_count
+
+    fprintf(fp, "        \"WhileDoStmt\": %d,\n", sample->mCounts.numWhileDoStmt);
+    fprintf(fp, "        \"DoWhileStmt\": %d,\n", sample->mCounts.numDoWhileStmt);
+    fprintf(fp, "        \"CForLoop\": %d,\n",    sample->mCounts.numCForLoop);
+    fprintf(fp, "        \"ForLoop\": %d,\n",     sample->mCounts.numForLoop);
+    fprintf(fp, "        \"ParamForLoop\": %d\n", sample->mCounts.numParamForLoop);
+    fprintf(fp, "      }\n");
+    fprintf(fp, "    }");
+  }
+
+  fprintf(fp, "\n  ]\n");
+  fprintf(fp, "}\n");
+}
+
 static void PassesSortByTime(std::vector<Pass>& passes)
 {
   std::sort(passes.begin(), passes.end(), SortByTime());
@@ -345,6 +494,62 @@ void Phase::ReportText(const char* text)
     fputs(text, printPassesFile);
 }
 
+/************************************* | **************************************
+*                                                                             *
+* Implementation of ResourceSample and PassSample                             *
+*                                                                             *
+************************************** | *************************************/
+
+ResourceSample::ResourceSample()
+{
+  mCpuUsecs   =  0;
+  mRssKiB     = -1;
+  mPeakRssKiB =  0;
+}
+
+void ResourceSample::Take()
+{
+  struct rusage usage;
+
+  if (getrusage(RUSAGE_SELF, &usage) == 0)
+  {
+    mCpuUsecs = (usage.ru_utime.tv_sec  + usage.ru_stime.tv_sec) * 1000000UL +
+                 usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+
+#ifdef __APPLE__
+    mPeakRssKiB = usage.ru_maxrss / 1024;   // bytes on Mac OS X
+#else
+    mPeakRssKiB = usage.ru_maxrss;
+#endif
+  }
+
+  // The current resident set size is only readily available on Linux
+  if (FILE* statm = fopen("/proc/self/statm", "r"))
+  {
+    long size     = 0;
+    long resident = 0;
+
+    if (fscanf(statm, "%ld %ld", &size, &resident) == 2)
+      mRssKiB = resident * (sysconf(_SC_PAGESIZE) / 1024);
+
+    fclose(statm);
+  }
+}
+
+PassSample::PassSample(const char* name, int passId)
+{
+  mName           = strdup(name);
+  mPassId         = passId;
+  mDone           = false;
+  mNumFnSymbols   = 0;
+  mNumTypeSymbols = 0;
+}
+
+PassSample::~PassSample()
+{
+  free(mName);
+}
+
 /************************************* | **************************************
 *                                                                             *
 * Implementation of Pass                                                      *
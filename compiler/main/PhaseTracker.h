@@ -57,10 +57,15 @@
 * of these passes.  Phases that occur before and after the Passes ignore      *
 * the check and clean phases.                                                 *
 *                                                                             *
+* For --print-passes-json the tracker also samples the CPU time and resident  *
+* set size at the start and end of every pass, and the AST at the end of it,  *
+* and writes them out as a JSON document.                                     *
+*                                                                             *
 ************************************** | *************************************/
 
 class Phase;
 class Pass;
+class PassSample;
 
 class PhaseTracker
 {
@@ -80,11 +85,15 @@ public:
 
   void                 Stop();
 
+  void                 SamplePass();
+
   void                 ReportPass  ()                                const;
   void                 ReportTotal ()                                const;
 
   void                 ReportRollup()                                const;
 
+  void                 ReportJson(FILE* fp)                          const;
+
 private:
   void                 PassesCollect(std::vector<Pass>& passes) const;
   
@@ -92,9 +101,10 @@ private:
                                   int         passId,
                                   SubPhase    subPhase);
 
-  Timer                mTimer;
-  int                  mPhaseId;
-  std::vector<Phase*>  mPhases;
+  Timer                    mTimer;
+  int                      mPhaseId;
+  std::vector<Phase*>      mPhases;
+  std::vector<PassSample*> mSamples;   // Only for --print-passes-json
 };
 
 #endif
@@ -0,0 +1,478 @@
+/*
+ * Copyright 2020 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/************************************* | **************************************
+*                                                                             *
+* The compile cache avoids re-running the compiler on inputs it has already   *
+* seen.  After parsing, every module file that the program depends on is      *
+* known, so a key is computed from                                            *
+*                                                                             *
+*   - the compiler binary and version                                         *
+*   - the command line and working directory                                  *
+*   - the CHPL_* configuration and flag-setting environment variables         *
+*   - the runtime and launcher libraries being linked against                 *
+*   - the contents of every parsed module file and named input file           *
+*                                                                             *
+* If <compileCacheDir>/<key>/manifest exists, the outputs recorded there are  *
+* copied into place and the compiler exits.  Otherwise the compilation runs   *
+* to completion and the resulting executable is stored under that key.        *
+*                                                                             *
+* Files that only become inputs after parsing (e.g. C sources pulled in with  *
+* 'require') are recorded in the manifest along with a hash of their contents *
+* and are re-validated before an entry is used.                               *
+*                                                                             *
+************************************** | *************************************/
+
+#include "compileCache.h"
+
+#include "arg.h"
+#include "docsDriver.h"
+#include "driver.h"
+#include "files.h"
+#include "insertLineNumbers.h"
+#include "misc.h"
+#include "stringutil.h"
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+char compileCacheDir[FILENAME_MAX+1] = "";
+
+static const char*                sCompilerPath   = NULL;
+static const ArgumentDescription* sArgDesc        = NULL;
+
+// The key for this compilation; empty if the cache is not in use.
+static std::string                sKey;
+
+// The number of input files that were covered by the key.
+static int                        sNumKeyedInputs = 0;
+
+static const char*                kManifestHeader = "chpl-compile-cache 1";
+
+/************************************* | **************************************
+*                                                                             *
+* 64-bit FNV-1a, which is plenty for distinguishing compilations and keeps    *
+* the compiler free of a crypto library dependency.                           *
+*                                                                             *
+************************************** | *************************************/
+
+class CacheHasher {
+public:
+                      CacheHasher();
+
+  void                addBytes(const void* data, size_t len);
+  void                addString(const char* str);
+  void                addInt(long long val);
+  void                addFileStat(const char* path);
+  void                addFileContents(const char* path);
+  void                addDirStats(const char* path);
+
+  std::string         digest()                                         const;
+
+private:
+  unsigned long long  mHash;
+};
+
+CacheHasher::CacheHasher() {
+  mHash = 14695981039346656037ULL;
+}
+
+void CacheHasher::addBytes(const void* data, size_t len) {
+  const unsigned char* bytes = (const unsigned char*) data;
+
+  for (size_t i = 0; i < len; i++) {
+    mHash ^= bytes[i];
+    mHash *= 1099511628211ULL;
+  }
+}
+
+// Include the terminator so that "ab","c" and "a","bc" hash differently
+void CacheHasher::addString(const char* str) {
+  if (str == NULL) {
+    str = "";
+  }
+
+  addBytes(str, strlen(str) + 1);
+}
+
+void CacheHasher::addInt(long long val) {
+  addBytes(&val, sizeof(val));
+}
+
+void CacheHasher::addFileStat(const char* path) {
+  struct stat st;
+
+  addString(path);
+
+  if (stat(path, &st) == 0) {
+    addInt(st.st_size);
+    addInt(st.st_mtime);
+  } else {
+    addInt(-1);
+  }
+}
+
+void CacheHasher::addFileContents(const char* path) {
+  addString(path);
+
+  if (FILE* fp = fopen(path, "rb")) {
+    char   buf[65536];
+    size_t len = 0;
+
+    while ((len = fread(buf, 1, sizeof(buf), fp)) > 0) {
+      addBytes(buf, len);
+    }
+
+    fclose(fp);
+
+  } else {
+    addInt(-1);
+  }
+}
+
+// The stat info of every file in a directory, in a stable order
+void CacheHasher::addDirStats(const char* path) {
+  std::vector<std::string> names;
+
+  addString(path);
+
+  if (DIR* dir = opendir(path)) {
+    while (struct dirent* ent = readdir(dir)) {
+      if (ent->d_name[0] != '.') {
+        names.push_back(ent->d_name);
+      }
+    }
+
+    closedir(dir);
+  }
+
+  std::sort(names.begin(), names.end());
+
+  for (size_t i = 0; i < names.size(); i++) {
+    addFileStat(astr(path, "/", names[i].c_str()));
+  }
+}
+
+std::string CacheHasher::digest() const {
+  char buf[32];
+
+  snprintf(buf, sizeof(buf), "%016llx", mHash);
+
+  return std::string(buf);
+}
+
+void initCompileCache(const char*                compilerPath,
+                      const ArgumentDescription* argDesc) {
+  sCompilerPath = compilerPath;
+  sArgDesc      = argDesc;
+}
+
+//
+// Only whole-program compilations that produce nothing but an executable
+// are cached.  Anything that asks for intermediate artifacts or stops
+// early compiles normally.
+//
+static bool compileCacheEnabled() {
+  return compileCacheDir[0] != '\0' &&
+         fDocs              == false &&
+         fParseOnly         == false &&
+         fLibraryCompile    == false &&
+         no_codegen         == false &&
+         saveCDir[0]        == '\0'  &&
+         stopAfterPass[0]   == '\0';
+}
+
+static std::string computeKey() {
+  CacheHasher hasher;
+
+  hasher.addString(kManifestHeader);
+  hasher.addString(compileVersion);
+
+  if (sCompilerPath != NULL) {
+    hasher.addFileStat(sCompilerPath);
+  }
+
+  hasher.addString(compileCommand);
+  hasher.addString(getCwd());
+
+  for (std::map<std::string, const char*>::iterator it = envMap.begin();
+       it != envMap.end();
+       ++it) {
+    hasher.addString(it->first.c_str());
+    hasher.addString(it->second);
+  }
+
+  // Flags can also be set through the environment.  Variables named with
+  // a leading '_' only mirror a flag into envMap, which is covered above.
+  for (int i = 0; sArgDesc != NULL && sArgDesc[i].name != NULL; i++) {
+    const char* env = sArgDesc[i].env;
+
+    if (env != NULL && env[0] != '_') {
+      hasher.addString(env);
+      hasher.addString(getenv(env));
+    }
+  }
+
+  hasher.addDirStats(astr(CHPL_RUNTIME_LIB, "/", CHPL_RUNTIME_SUBDIR));
+
+  if (strcmp(CHPL_LAUNCHER, "none") != 0) {
+    hasher.addDirStats(astr(CHPL_RUNTIME_LIB, "/", CHPL_LAUNCHER_SUBDIR));
+  }
+
+  for (size_t i = 0; i < gFilenameLookup.size(); i++) {
+    hasher.addFileContents(gFilenameLookup[i].c_str());
+  }
+
+  sNumKeyedInputs = 0;
+
+  while (const char* filename = nthFilename(sNumKeyedInputs)) {
+    hasher.addFileContents(filename);
+    sNumKeyedInputs++;
+  }
+
+  return hasher.digest();
+}
+
+static std::string fileContentsDigest(const char* path) {
+  CacheHasher hasher;
+
+  hasher.addFileContents(path);
+
+  return hasher.digest();
+}
+
+static const char* entryDirName() {
+  return astr(compileCacheDir, "/", sKey.c_str());
+}
+
+// The files that make up the result of a compilation
+static std::vector<const char*> compileOutputs() {
+  std::vector<const char*> retval;
+
+  retval.push_back(executableFilename);
+
+  if (strcmp(CHPL_LAUNCHER, "none") != 0) {
+    retval.push_back(astr(executableFilename, "_real"));
+  }
+
+  return retval;
+}
+
+static bool readLine(FILE* fp, std::string& line) {
+  int c = 0;
+
+  line.clear();
+
+  while ((c = getc(fp)) != EOF && c != '\n') {
+    line.push_back((char) c);
+  }
+
+  return c != EOF || line.empty() == false;
+}
+
+// Split "<word> <field> <rest of line>"; the last field may hold spaces
+static bool splitManifestLine(const std::string& line,
+                              std::string&       word,
+                              std::string&       field,
+                              std::string&       rest) {
+  size_t sp1 = line.find(' ');
+  size_t sp2 = (sp1 == std::string::npos) ? sp1 : line.find(' ', sp1 + 1);
+
+  if (sp2 == std::string::npos) {
+    return false;
+  }
+
+  word  = line.substr(0, sp1);
+  field = line.substr(sp1 + 1, sp2 - sp1 - 1);
+  rest  = line.substr(sp2 + 1);
+
+  return true;
+}
+
+static bool copyFile(const char* from, const char* to) {
+  struct stat st;
+  FILE*       in     = NULL;
+  FILE*       out    = NULL;
+  bool        retval = true;
+
+  if (stat(from, &st) != 0 || (in = fopen(from, "rb")) == NULL) {
+    return false;
+  }
+
+  // Unlink first so that a running copy of the old file is left alone
+  unlink(to);
+
+  if ((out = fopen(to, "wb")) == NULL) {
+    fclose(in);
+    return false;
+  }
+
+  char   buf[65536];
+  size_t len = 0;
+
+  while (retval == true && (len = fread(buf, 1, sizeof(buf), in)) > 0) {
+    retval = fwrite(buf, 1, len, out) == len;
+  }
+
+  fclose(in);
+
+  if (fclose(out) != 0) {
+    retval = false;
+  }
+
+  if (retval == true) {
+    chmod(to, st.st_mode & 0777);
+  }
+
+  return retval;
+}
+
+void compileCacheLookup() {
+  if (compileCacheEnabled() == false) {
+    return;
+  }
+
+  sKey = computeKey();
+
+  const char*                                       entryDir = entryDirName();
+  FILE*                                             manifest = NULL;
+  std::vector<std::pair<std::string, std::string> > outputs;
+  std::string                                       line;
+  bool                                              valid    = false;
+
+  if ((manifest = fopen(astr(entryDir, "/manifest"), "r")) == NULL) {
+    return;
+  }
+
+  if (readLine(manifest, line) && line == kManifestHeader) {
+    std::string word;
+    std::string field;
+    std::string path;
+
+    valid = true;
+
+    while (valid == true && readLine(manifest, line)) {
+      if (splitManifestLine(line, word, field, path) == false) {
+        valid = false;
+
+      } else if (word == "output") {
+        outputs.push_back(std::make_pair(field, path));
+
+      } else if (word == "depends") {
+        valid = field == fileContentsDigest(path.c_str());
+
+      } else {
+        valid = false;
+      }
+    }
+  }
+
+  fclose(manifest);
+
+  if (valid == false || outputs.empty() == true) {
+    return;
+  }
+
+  for (size_t i = 0; i < outputs.size(); i++) {
+    const char* from = astr(entryDir, "/", outputs[i].first.c_str());
+
+    // Fall back to a normal compilation, which will refresh the entry
+    if (copyFile(from, outputs[i].second.c_str()) == false) {
+      return;
+    }
+  }
+
+  clean_exit(0);
+}
+
+void compileCacheStore() {
+  // Don't let a cache hit silently drop diagnostics
+  if (sKey.empty() == true || warningsEncountered() == true) {
+    return;
+  }
+
+  std::vector<const char*> outputs  = compileOutputs();
+  const char*              entryDir = entryDirName();
+  const char*              tmpDir   = NULL;
+  FILE*                    manifest = NULL;
+  bool                     ok       = true;
+  char                     pidStr[32];
+
+  snprintf(pidStr, sizeof(pidStr), "%d", (int) getpid());
+
+  tmpDir = astr(entryDir, ".tmp-", pidStr);
+
+  ensureDirExists(compileCacheDir, "ensuring compile cache directory exists");
+
+  if (mkdir(tmpDir, 0755) != 0) {
+    return;
+  }
+
+  if ((manifest = fopen(astr(tmpDir, "/manifest"), "w")) == NULL) {
+    deleteDir(tmpDir);
+    return;
+  }
+
+  fprintf(manifest, "%s\n", kManifestHeader);
+
+  for (size_t i = 0; i < outputs.size() && ok == true; i++) {
+    char name[32];
+
+    snprintf(name, sizeof(name), "output%d", (int) i);
+
+    ok = copyFile(outputs[i], astr(tmpDir, "/", name));
+
+    fprintf(manifest, "output %s %s\n", name, outputs[i]);
+  }
+
+  // Inputs that were only discovered after the key was computed
+  for (int i = sNumKeyedInputs; nthFilename(i) != NULL; i++) {
+    const char* filename = nthFilename(i);
+
+    fprintf(manifest,
+            "depends %s %s\n",
+            fileContentsDigest(filename).c_str(),
+            filename);
+  }
+
+  if (fclose(manifest) != 0) {
+    ok = false;
+  }
+
+  // Publish the entry atomically, replacing one that failed validation
+  if (ok == true && rename(tmpDir, entryDir) != 0) {
+    deleteDir(entryDir);
+
+    ok = rename(tmpDir, entryDir) == 0;
+  }
+
+  if (ok == false) {
+    deleteDir(tmpDir);
+  }
+}
@@ -28,6 +28,7 @@
 #include "arg.h"
 #include "chpl.h"
 #include "commonFlags.h"
+#include "compileCache.h"
 #include "config.h"
 #include "countTokens.h"
 #include "docsDriver.h"
@@ -48,6 +49,7 @@
 #include "version.h"
 
 #include <inttypes.h>
+#include <unistd.h>
 #include <string>
 #include <sstream>
 #include <map>
@@ -125,7 +127,9 @@ bool fFastFlag = false;
 bool fUseNoinit = true;
 bool fNoCopyPropagation = false;
 bool fNoDeadCodeElimination = false;
+bool fNoDevirtualize = false;
 bool fNoScalarReplacement = false;
+bool fNoStackAllocateClasses = false;
 bool fNoTupleCopyOpt = false;
 bool fNoRemoteValueForwarding = false;
 bool fNoInferConstRefs = false;
@@ -156,8 +160,9 @@ bool fNoCastChecks = false;
 bool fMungeUserIdents = true;
 bool fEnableTaskTracking = false;
 
-bool  printPasses     = false;
-FILE* printPassesFile = NULL;
+bool  printPasses         = false;
+FILE* printPassesFile     = NULL;
+FILE* printPassesJsonFile = NULL;
 
 // flag for llvmWideOpt
 bool fLLVMWideOpt = false;
@@ -181,6 +186,7 @@ bool fRemoveUnreachableBlocks = true;
 bool fMinimalModules = false;
 bool fIncrementalCompilation = false;
 bool fNoOptimizeForallUnordered = false;
+bool fAutoAggregation = false;
 
 int optimize_on_clause_limit = 20;
 int scalar_replace_limit = 8;
@@ -188,6 +194,10 @@ int inline_iter_yield_limit = 10;
 int tuple_copy_limit = scalar_replace_limit;
 bool fGenIDS = false;
 int fLinkStyle = LS_DEFAULT; // use backend compiler's default
+int fBackendJobs = 0; // 0 -> one per available processor
+int fPassThreads = 0; // 0 -> one per available processor
+char fProfileGen[FILENAME_MAX+1] = "";
+char fProfileUse[FILENAME_MAX+1] = "";
 bool fUserSetLocal = false;
 bool fLocal;   // initialized in postLocal()
 bool fIgnoreLocalClasses = false;
@@ -223,11 +233,16 @@ bool fReportOptimizedLoopIterators = false;
 bool fReportInlinedIterators = false;
 bool fReportVectorizedLoops = false;
 bool fReportOptimizedOn = false;
+bool fReportAutoAggregation = false;
 bool fReportOptimizeForallUnordered = false;
 bool fReportPromotion = false;
 bool fReportScalarReplace = false;
+bool fReportStackAllocatedClasses = false;
 bool fReportDeadBlocks = false;
+bool fReportDevirtualizedCalls = false;
 bool fReportDeadModules = false;
+bool fReportWideReferences = false;
+bool fReportForwardedFields = false;
 bool fPermitUnhandledModuleErrors = false;
 #ifdef HAVE_LLVM_RV
 bool fRegionVectorizer = true;
@@ -718,6 +733,7 @@ static void setFastFlag(const ArgumentDescription* desc, const char* unused) {
   // an appropriate level of optimization.
   fNoCopyPropagation = false;
   fNoDeadCodeElimination = false;
+  fNoDevirtualize = false;
   fNoFastFollowers = false;
   fNoLoopInvariantCodeMotion= false;
   fNoInterproceduralAliasAnalysis = false;
@@ -731,6 +747,7 @@ static void setFastFlag(const ArgumentDescription* desc, const char* unused) {
   fNoRemoteSerialization = false;
   fNoRemoveCopyCalls = false;
   fNoScalarReplacement = false;
+  fNoStackAllocateClasses = false;
   fNoTupleCopyOpt = false;
   fNoPrivatization = false;
   fNoChecks = true;
@@ -767,6 +784,7 @@ static void setBaselineFlag(const ArgumentDescription* desc, const char* unused)
 
   fNoCopyPropagation = true;          // --no-copy-propagation
   fNoDeadCodeElimination = true;      // --no-dead-code-elimination
+  fNoDevirtualize = true;             // --no-devirtualize
   fNoFastFollowers = true;            // --no-fast-followers
   fNoLoopInvariantCodeMotion = true;  // --no-loop-invariant-code-motion
                                       // --no-interprocedural-alias-analysis
@@ -782,6 +800,7 @@ static void setBaselineFlag(const ArgumentDescription* desc, const char* unused)
   fNoRemoteSerialization = true;      // --no-remote-serialization
   fNoRemoveCopyCalls = true;          // --no-remove-copy-calls
   fNoScalarReplacement = true;        // --no-scalar-replacement
+  fNoStackAllocateClasses = true;     // --no-stack-allocate-classes
   fNoTupleCopyOpt = true;             // --no-tuple-copy-opt
   fNoPrivatization = true;            // --no-privatization
   fNoOptimizeOnClauses = true;        // --no-optimize-on-clauses
@@ -838,6 +857,14 @@ static void setPrintPassesFile(const ArgumentDescription* desc, const char* file
   }
 }
 
+static void setPrintPassesJsonFile(const ArgumentDescription* desc, const char* fileName) {
+  printPassesJsonFile = fopen(fileName, "w");
+
+  if (printPassesJsonFile == NULL) {
+    USR_WARN("Error opening printPassesJsonFile: %s.", fileName);
+  }
+}
+
 static void setLocal (const ArgumentDescription* desc, const char* unused) {
   // Used in postLocal() to set fLocal if user threw flag
   fUserSetLocal = true;
@@ -905,10 +932,12 @@ static ArgumentDescription arg_desc[] = {
  {"local", ' ', NULL, "Target one [many] locale[s]", "N", &fLocal, "CHPL_LOCAL", setLocal},
 
  {"", ' ', NULL, "Optimization Control Options", NULL, NULL, NULL, NULL},
+ {"auto-aggregation", ' ', NULL, "Enable [disable] automatic aggregation of remote updates in foralls", "N", &fAutoAggregation, "CHPL_AUTO_AGGREGATION", NULL},
  {"baseline", ' ', NULL, "Disable all Chapel optimizations", "F", &fBaseline, "CHPL_BASELINE", setBaselineFlag},
  {"cache-remote", ' ', NULL, "[Don't] enable cache for remote data", "N", &fCacheRemote, "CHPL_CACHE_REMOTE", setCacheEnable},
  {"copy-propagation", ' ', NULL, "Enable [disable] copy propagation", "n", &fNoCopyPropagation, "CHPL_DISABLE_COPY_PROPAGATION", NULL},
  {"dead-code-elimination", ' ', NULL, "Enable [disable] dead code elimination", "n", &fNoDeadCodeElimination, "CHPL_DISABLE_DEAD_CODE_ELIMINATION", NULL},
+ {"devirtualize", ' ', NULL, "Enable [disable] direct calls to overridden methods when the receiver's class is known", "n", &fNoDevirtualize, "CHPL_DISABLE_DEVIRTUALIZE", NULL},
  {"fast", ' ', NULL, "Disable checks; optimize/specialize code", "F", &fFastFlag, "CHPL_FAST", setFastFlag},
  {"fast-followers", ' ', NULL, "Enable [disable] fast followers", "n", &fNoFastFollowers, "CHPL_DISABLE_FAST_FOLLOWERS", NULL},
  {"ieee-float", ' ', NULL, "Generate code that is strict [lax] with respect to IEEE compliance", "N", &fieeefloat, "CHPL_IEEE_FLOAT", setFloatOptFlag},
@@ -923,12 +952,16 @@ static ArgumentDescription arg_desc[] = {
  {"optimize-loop-iterators", ' ', NULL, "Enable [disable] optimization of iterators composed of a single loop", "n", &fNoOptimizeLoopIterators, "CHPL_DISABLE_OPTIMIZE_LOOP_ITERATORS", NULL},
  {"optimize-on-clauses", ' ', NULL, "Enable [disable] optimization of on clauses", "n", &fNoOptimizeOnClauses, "CHPL_DISABLE_OPTIMIZE_ON_CLAUSES", NULL},
  {"optimize-on-clause-limit", ' ', "<limit>", "Limit recursion depth of on clause optimization search", "I", &optimize_on_clause_limit, "CHPL_OPTIMIZE_ON_CLAUSE_LIMIT", NULL},
+ {"pass-threads", ' ', "<n>", "Number of threads for per-function optimization analyses, 0 for one per processor", "I", &fPassThreads, "CHPL_PASS_THREADS", NULL},
  {"privatization", ' ', NULL, "Enable [disable] privatization of distributed arrays and domains", "n", &fNoPrivatization, "CHPL_DISABLE_PRIVATIZATION", NULL},
+ {"profile-gen", ' ', "<filename>", "Make the program write its function call counts to <filename>", "P", fProfileGen, "CHPL_PROFILE_GEN", NULL},
+ {"profile-use", ' ', "<filename>", "Inline hot functions and mark cold ones using call counts from <filename>", "P", fProfileUse, "CHPL_PROFILE_USE", NULL},
  {"remote-value-forwarding", ' ', NULL, "Enable [disable] remote value forwarding", "n", &fNoRemoteValueForwarding, "CHPL_DISABLE_REMOTE_VALUE_FORWARDING", NULL},
  {"remote-serialization", ' ', NULL, "Enable [disable] serialization for remote consts", "n", &fNoRemoteSerialization, "CHPL_DISABLE_REMOTE_SERIALIZATION", NULL},
  {"remove-copy-calls", ' ', NULL, "Enable [disable] remove copy calls", "n", &fNoRemoveCopyCalls, "CHPL_DISABLE_REMOVE_COPY_CALLS", NULL},
  {"scalar-replacement", ' ', NULL, "Enable [disable] scalar replacement", "n", &fNoScalarReplacement, "CHPL_DISABLE_SCALAR_REPLACEMENT", NULL},
  {"scalar-replace-limit", ' ', "<limit>", "Limit on the size of tuples being replaced during scalar replacement", "I", &scalar_replace_limit, "CHPL_SCALAR_REPLACE_TUPLE_LIMIT", NULL},
+ {"stack-allocate-classes", ' ', NULL, "Enable [disable] stack allocation of class instances that do not escape", "n", &fNoStackAllocateClasses, "CHPL_DISABLE_STACK_ALLOCATE_CLASSES", NULL},
  {"tuple-copy-opt", ' ', NULL, "Enable [disable] tuple (memcpy) optimization", "n", &fNoTupleCopyOpt, "CHPL_DISABLE_TUPLE_COPY_OPT", NULL},
  {"tuple-copy-limit", ' ', "<limit>", "Limit on the size of tuples considered for optimization", "I", &tuple_copy_limit, "CHPL_TUPLE_COPY_LIMIT", NULL},
  {"use-noinit", ' ', NULL, "Enable [disable] ability to skip default initialization through the keyword noinit", "N", &fUseNoinit, NULL, NULL},
@@ -953,6 +986,7 @@ static ArgumentDescription arg_desc[] = {
  {"savec", ' ', "<directory>", "Save generated C code in directory", "P", saveCDir, "CHPL_SAVEC_DIR", verifySaveCDir},
 
  {"", ' ', NULL, "C Code Compilation Options", NULL, NULL, NULL, NULL},
+ {"backend-jobs", ' ', "<n>", "Number of parallel back-end compile jobs, 0 for one per processor", "I", &fBackendJobs, "CHPL_BACKEND_JOBS", NULL},
  {"ccflags", ' ', "<flags>", "Back-end C compiler flags (can be specified multiple times)", "S", NULL, "CHPL_CC_FLAGS", setCCFlags},
  {"debug", 'g', NULL, "[Don't] Support debugging of generated C code", "N", &debugCCode, "CHPL_DEBUG", setChapelDebug},
  {"dynamic", ' ', NULL, "Generate a dynamically linked binary", "F", &fLinkStyle, NULL, setDynamicLink},
@@ -974,11 +1008,13 @@ static ArgumentDescription arg_desc[] = {
  {"print-commands", ' ', NULL, "[Don't] print system commands", "N", &printSystemCommands, "CHPL_PRINT_COMMANDS", NULL},
  {"print-passes", ' ', NULL, "[Don't] print compiler passes", "N", &printPasses, "CHPL_PRINT_PASSES", NULL},
  {"print-passes-file", ' ', "<filename>", "Print compiler passes to <filename>", "S", NULL, "CHPL_PRINT_PASSES_FILE", setPrintPassesFile},
+ {"print-passes-json", ' ', "<filename>", "Print pass statistics as JSON to <filename>", "S", NULL, "CHPL_PRINT_PASSES_JSON", setPrintPassesJsonFile},
 
  {"", ' ', NULL, "Miscellaneous Options", NULL, NULL, NULL, NULL},
 // Support for extern { c-code-here } blocks could be toggled with this
 // flag, but instead we just leave it on if the compiler can do it.
 // {"extern-c", ' ', NULL, "Enable [disable] extern C block support", "f", &externC, "CHPL_EXTERN_C", NULL},
+ {"compile-cache-dir", ' ', "<directory>", "Reuse results of identical compilations cached in directory", "P", compileCacheDir, "CHPL_COMPILE_CACHE_DIR", NULL},
  DRIVER_ARG_DEVELOPER,
  {"explain-call", ' ', "<call>[:<module>][:<line>]", "Explain resolution of call", "S256", fExplainCall, NULL, NULL},
  {"explain-instantiation", ' ', "<function|type>[:<module>][:<line>]", "Explain instantiation of type", "S256", fExplainInstantiation, NULL, NULL},
@@ -1049,10 +1085,13 @@ static ArgumentDescription arg_desc[] = {
  {"print-dispatch", ' ', NULL, "Print dynamic dispatch table", "F", &fPrintDispatch, NULL, NULL},
  {"print-statistics", ' ', "[n|k|t]", "Print AST statistics", "S256", fPrintStatistics, NULL, NULL},
  {"report-aliases", ' ', NULL, "Report aliases in user code", "N", &fReportAliases, NULL, NULL},
+ {"report-auto-aggregation", ' ', NULL, "Show which foralls aggregate their remote updates", "F", &fReportAutoAggregation, NULL, NULL},
  {"report-blocking", ' ', NULL, "Report blocking functions in user code", "N", &fReportBlocking, NULL, NULL},
  {"report-inlining", ' ', NULL, "Print inlined functions", "F", &report_inlining, NULL, NULL},
  {"report-dead-blocks", ' ', NULL, "Print dead block removal stats", "F", &fReportDeadBlocks, NULL, NULL},
+ {"report-devirtualized-calls", ' ', NULL, "Show which calls to overridden methods are made directly", "F", &fReportDevirtualizedCalls, NULL, NULL},
  {"report-dead-modules", ' ', NULL, "Print dead module removal stats", "F", &fReportDeadModules, NULL, NULL},
+ {"report-forwarded-fields", ' ', NULL, "Show which field reads are forwarded into on-statements", "F", &fReportForwardedFields, NULL, NULL},
  {"report-optimized-loop-iterators", ' ', NULL, "Print stats on optimized single loop iterators", "F", &fReportOptimizedLoopIterators, NULL, NULL},
  {"report-inlined-iterators", ' ', NULL, "Print stats on inlined iterators", "F", &fReportInlinedIterators, NULL, NULL},
  {"report-vectorized-loops", ' ', NULL, "Show which loops have vectorization hints", "F", &fReportVectorizedLoops, NULL, NULL},
@@ -1060,6 +1099,8 @@ static ArgumentDescription arg_desc[] = {
  {"report-optimized-forall-unordered-ops", ' ', NULL, "Show which statements in foralls have been converted to unordered operations", "F", &fReportOptimizeForallUnordered, NULL, NULL},
  {"report-promotion", ' ', NULL, "Print information about scalar promotion", "F", &fReportPromotion, NULL, NULL},
  {"report-scalar-replace", ' ', NULL, "Print scalar replacement stats", "F", &fReportScalarReplace, NULL, NULL},
+ {"report-stack-allocated-classes", ' ', NULL, "Show which class instances are allocated on the stack", "F", &fReportStackAllocatedClasses, NULL, NULL},
+ {"report-wide-references", ' ', NULL, "Show which variables are wide references and why", "F", &fReportWideReferences, NULL, NULL},
 
  {"", ' ', NULL, "Developer Flags -- Miscellaneous", NULL, NULL, NULL, NULL},
  DRIVER_ARG_BREAKFLAGS_COMMON,
@@ -1418,6 +1459,24 @@ static void setMaxCIndentLen() {
   if (gotPGI) fMaxCIdentLen = 1020;
 }
 
+static int numOnlineProcessors() {
+  long nprocs = sysconf(_SC_NPROCESSORS_ONLN);
+
+  return (nprocs > 0) ? (int) nprocs : 1;
+}
+
+static void setBackendJobs() {
+  if (fBackendJobs <= 0) {
+    fBackendJobs = numOnlineProcessors();
+  }
+}
+
+static void setPassThreads() {
+  if (fPassThreads <= 0) {
+    fPassThreads = numOnlineProcessors();
+  }
+}
+
 static void setPrintCppLineno() {
   if (developer && !userSetCppLineno) printCppLineno = false;
 }
@@ -1485,6 +1544,10 @@ static void postprocess_args() {
 
   setMaxCIndentLen();
 
+  setBackendJobs();
+
+  setPassThreads();
+
   postLocal();
 
   postVectorize();
@@ -1554,6 +1617,8 @@ int main(int argc, char* argv[]) {
     setupModulePaths();
 
     recordCodeGenStrings(argc, argv);
+
+    initCompileCache(sArgState.program_loc, arg_desc);
   } // astlocMarker scope
 
   printStuff(argv[0]);
@@ -1584,6 +1649,11 @@ int main(int argc, char* argv[]) {
     fclose(printPassesFile);
   }
 
+  if (printPassesJsonFile != NULL) {
+    tracker.ReportJson(printPassesJsonFile);
+    fclose(printPassesJsonFile);
+  }
+
   clean_exit(0);
 
   return 0;
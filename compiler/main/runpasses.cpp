@@ -20,7 +20,10 @@
 
 #include "runpasses.h"
 
+#include "analysisManager.h"
+#include "astArena.h"
 #include "checks.h"
+#include "compileCache.h"
 #include "driver.h"
 #include "log.h"
 #include "parser.h"
@@ -28,6 +31,8 @@
 #include "PhaseTracker.h"
 
 #include <cstdio>
+#include <pthread.h>
+#include <sys/resource.h>
 #include <sys/time.h>
 
 int   currentPassNo   = 1;
@@ -173,6 +178,12 @@ void runPasses(PhaseTracker& tracker, bool isChpldoc) {
 
     currentPassNo++;
 
+    // Once parsing has found every module file, reuse a cached result
+    // of an identical compilation if there is one
+    if (strcmp(sPassList[i].name, "parse") == 0) {
+      compileCacheLookup();
+    }
+
     // Break early if this is a parse-only run
     if (fParseOnly ==  true && strcmp(sPassList[i].name, "checkParsed") == 0) {
       break;
@@ -189,10 +200,19 @@ void runPasses(PhaseTracker& tracker, bool isChpldoc) {
     }
   }
 
+  compileCacheStore();
+
   destroyAst();
   teardownLogfiles();
 }
 
+static bool preservesAnalyses(const char* passName) {
+  return strcmp(passName, "copyPropagation")     == 0 ||
+         strcmp(passName, "deadCodeElimination") == 0 ||
+         strcmp(passName, "removeEmptyRecords")  == 0 ||
+         strcmp(passName, "localizeGlobals")     == 0;
+}
+
 static void runPass(PhaseTracker& tracker, size_t passIndex, bool isChpldoc) {
   PassInfo* info = &sPassList[passIndex];
 
@@ -235,6 +255,21 @@ static void runPass(PhaseTracker& tracker, size_t passIndex, bool isChpldoc) {
     cleanAst();
   }
 
+  // The analyses cached for a function can only be kept across passes
+  // that edit nothing but function bodies (see analysisManager.h)
+  if (preservesAnalyses(info->name) == false) {
+    freeAllAnalyses(info->name);
+  }
+
+  // Give back the memory of the functions and types that were pruned
+  if (strcmp(info->name, "prune") == 0 || strcmp(info->name, "prune2") == 0) {
+    astArenaCompact(info->name);
+  }
+
+  if (printPassesJsonFile != 0) {
+    tracker.SamplePass();
+  }
+
   if (printPasses == true || printPassesFile != 0) {
     tracker.ReportPass();
   }
@@ -258,3 +293,99 @@ void initPassesForLogging() {
     logMakePassAvailable(pass->name, pass->logTag);
   }
 }
+
+//
+// A minimal work queue for forEachFnConcurrently(): each thread claims
+// the next unclaimed function index until the vector is exhausted.
+//
+struct FnWorkQueue {
+  std::vector<FnSymbol*>* fns;
+  void                  (*analyze)(FnSymbol* fn, size_t i, void* data);
+  void*                   data;
+
+  pthread_mutex_t         lock;
+  size_t                  next;
+};
+
+static void* fnWorker(void* arg) {
+  FnWorkQueue* queue = static_cast<FnWorkQueue*>(arg);
+
+  while (true) {
+    pthread_mutex_lock(&queue->lock);
+    size_t i = queue->next++;
+    pthread_mutex_unlock(&queue->lock);
+
+    if (i >= queue->fns->size())
+      break;
+
+    queue->analyze((*queue->fns)[i], i, queue->data);
+  }
+
+  return NULL;
+}
+
+// Give the workers at least as much stack as the main thread; the
+// analyses recurse over the AST.
+static size_t workerStackSize() {
+  size_t        size = 8 * 1024 * 1024;
+  struct rlimit limit;
+
+  if (getrlimit(RLIMIT_STACK, &limit) == 0 &&
+      limit.rlim_cur != RLIM_INFINITY       &&
+      (size_t) limit.rlim_cur > size) {
+    size = limit.rlim_cur;
+  }
+
+  return size;
+}
+
+void forEachFnConcurrently(std::vector<FnSymbol*>& fns,
+                           void (*analyze)(FnSymbol* fn,
+                                           size_t    i,
+                                           void*     data),
+                           void* data) {
+  size_t nThreads = fPassThreads > 1 ? (size_t) fPassThreads : 1;
+
+  if (nThreads > fns.size())
+    nThreads = fns.size();
+
+  if (nThreads <= 1) {
+    for (size_t i = 0; i < fns.size(); i++)
+      analyze(fns[i], i, data);
+
+    return;
+  }
+
+  FnWorkQueue               queue;
+  std::vector<pthread_t>    threads;
+  pthread_attr_t            attr;
+
+  queue.fns     = &fns;
+  queue.analyze = analyze;
+  queue.data    = data;
+  queue.next    = 0;
+
+  pthread_mutex_init(&queue.lock, NULL);
+
+  pthread_attr_init(&attr);
+  pthread_attr_setstacksize(&attr, workerStackSize());
+
+  // The calling thread is one of the workers.  If a thread can't be
+  // created, the ones that were still drain the queue.
+  for (size_t t = 1; t < nThreads; t++) {
+    pthread_t thread;
+
+    if (pthread_create(&thread, &attr, fnWorker, &queue) != 0)
+      break;
+
+    threads.push_back(thread);
+  }
+
+  fnWorker(&queue);
+
+  for (size_t t = 0; t < threads.size(); t++)
+    pthread_join(threads[t], NULL);
+
+  pthread_attr_destroy(&attr);
+  pthread_mutex_destroy(&queue.lock);
+}
@@ -0,0 +1,284 @@
+/*
+ * Copyright 2020 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/************************************* | **************************************
+*                                                                             *
+* --auto-aggregation                                                          *
+*                                                                             *
+* A forall loop whose body ends in                                            *
+*                                                                             *
+*     A[i] = v;                  or      A[i].add(v);                         *
+*                                                                             *
+* where 'A' is declared outside the loop and is not otherwise referenced by   *
+* it, is rewritten before normalization into                                  *
+*                                                                             *
+*     forall ... with (var chpl__dstAgg_A = chpl__dstAggregatorFor(A, add)) { *
+*       ...                                                                   *
+*       if chpl__isAggregatable(A, add) then                                  *
+*         chpl__dstAgg_A.copy(A[i], v);             // or .add(A[i], v)       *
+*       else                                                                  *
+*         A[i] = v;                                 // the original           *
+*     }                                                                       *
+*                                                                             *
+* chpl__isAggregatable() is a param function, so resolution keeps only one    *
+* of the branches.  It picks the aggregator for distributed arrays of POD     *
+* or atomic elements.  The aggregator buffers the updates per destination     *
+* locale, see modules/internal/ChapelAutoAggregation.chpl.                    *
+*                                                                             *
+* Delaying an update until the end of the task is fine because it is the      *
+* last thing the iteration does, and nothing else in the loop could observe   *
+* 'A'.  This is the same reasoning as optimizeForallUnorderedOps() uses.      *
+*                                                                             *
+* Gathers, where that last statement is                                       *
+*                                                                             *
+*     B[i] = A[j];                                                            *
+*                                                                             *
+* and neither 'A' nor 'B' is otherwise referenced by the loop, are guarded    *
+* the same way with chpl__isGatherable(A, B) and a chpl__srcAgg_A aggregator  *
+* ahead of the scatter check above.  That aggregator buffers the addresses    *
+* of the remote elements of 'A' per source locale and fetches a full buffer   *
+* of them with a single on-statement, so the stores to 'B' are delayed.       *
+*                                                                             *
+************************************** | *************************************/
+
+#include "optimizations.h"
+
+#include "astutil.h"
+#include "build.h"
+#include "driver.h"
+#include "expr.h"
+#include "ForallStmt.h"
+#include "stmt.h"
+#include "stringutil.h"
+#include "symbol.h"
+
+static const char* kDstAggregatorPrefix = "chpl__dstAgg_";
+static const char* kSrcAggregatorPrefix = "chpl__srcAgg_";
+
+static Symbol* aggregatedArray(CallExpr* stmt, CallExpr*& lhs, Expr*& rhs,
+                               bool& isAdd);
+static Symbol* gatheredArray(CallExpr* stmt, Symbol*& dst);
+static Symbol* accessedArray(Expr* expr);
+static bool    isOnlyReference(ForallStmt* fs, Symbol* arr);
+static void    guardLastStmt(ForallStmt* fs, CallExpr* stmt,
+                             const char* prefix, Symbol* arr,
+                             CallExpr* init, CallExpr* isAgg,
+                             const char* method, Expr* lhs, Expr* rhs);
+
+void autoAggregateForalls() {
+  if (fAutoAggregation == false) {
+    return;
+  }
+
+  forv_Vec(ForallStmt, fs, gForallStmts) {
+    if (fs->inTree() == false || fs->getModule()->modTag != MOD_USER) {
+      continue;
+    }
+
+    if (CallExpr* stmt = toCallExpr(fs->loopBody()->body.tail)) {
+      CallExpr* lhs     = NULL;
+      Expr*     rhs     = NULL;
+      bool      isAdd   = false;
+      Symbol*   dst     = NULL;
+      Symbol*   scatter = aggregatedArray(stmt, lhs, rhs, isAdd);
+      Symbol*   gather  = gatheredArray(stmt, dst);
+
+      // Decide both before either rewrite adds references to the arrays
+      if (scatter != NULL && isOnlyReference(fs, scatter) == false) {
+        scatter = NULL;
+      }
+
+      if (gather != NULL && (isOnlyReference(fs, gather) == false ||
+                             isOnlyReference(fs, dst)    == false)) {
+        gather = NULL;
+      }
+
+      // The scatter, if any, becomes the fallback of the gather
+      if (gather != NULL) {
+        SET_LINENO(stmt);
+
+        guardLastStmt(fs, stmt, kSrcAggregatorPrefix, gather,
+                      new CallExpr("chpl__srcAggregatorFor",
+                                   new SymExpr(gather),
+                                   new SymExpr(dst)),
+                      new CallExpr("chpl__isGatherable",
+                                   new SymExpr(gather),
+                                   new SymExpr(dst)),
+                      "copy", stmt->get(1), stmt->get(2));
+      }
+
+      if (scatter != NULL) {
+        SET_LINENO(stmt);
+
+        Symbol*   addFlag = isAdd ? gTrue : gFalse;
+        CallExpr* init    = new CallExpr("chpl__dstAggregatorFor",
+                                         new SymExpr(scatter),
+                                         addFlag);
+
+        // Do not allocate buffers that the gather branch leaves unused
+        if (gather != NULL) {
+          init->insertAtTail(new CallExpr("chpl__isGatherable",
+                                          new SymExpr(gather),
+                                          new SymExpr(dst)));
+        }
+
+        guardLastStmt(fs, stmt, kDstAggregatorPrefix, scatter, init,
+                      new CallExpr("chpl__isAggregatable",
+                                   new SymExpr(scatter),
+                                   addFlag),
+                      isAdd ? "add" : "copy", lhs, rhs);
+      }
+    }
+  }
+}
+
+//
+// Returns 'A' if 'stmt' is 'A[i] = v' or 'A[i].add(v)', else NULL
+//
+static Symbol* aggregatedArray(CallExpr* stmt, CallExpr*& lhs, Expr*& rhs,
+                               bool& isAdd) {
+  if (stmt->isNamedAstr(astrSassign) && stmt->numActuals() == 2) {
+    lhs   = toCallExpr(stmt->get(1));
+    rhs   = stmt->get(2);
+    isAdd = false;
+
+  } else if (CallExpr* dot = toCallExpr(stmt->baseExpr)) {
+    const char* method = NULL;
+
+    if (dot->isNamedAstr(astrSdot)            == true &&
+        get_string(dot->get(2), &method)      == true &&
+        strcmp(method, "add")                 == 0    &&
+        stmt->numActuals()                    == 1    &&
+        isNamedExpr(stmt->get(1))             == false) {
+      lhs   = toCallExpr(dot->get(1));
+      rhs   = stmt->get(1);
+      isAdd = true;
+    }
+  }
+
+  return lhs != NULL ? accessedArray(lhs) : NULL;
+}
+
+//
+// Returns 'A' and sets 'dst' to 'B' if 'stmt' is 'B[i] = A[j]', else NULL
+//
+static Symbol* gatheredArray(CallExpr* stmt, Symbol*& dst) {
+  if (stmt->isNamedAstr(astrSassign) && stmt->numActuals() == 2) {
+    Symbol* src = accessedArray(stmt->get(2));
+
+    dst = accessedArray(stmt->get(1));
+
+    if (src != NULL && dst != NULL && src != dst) {
+      return src;
+    }
+  }
+
+  return NULL;
+}
+
+// Returns 'A' if 'expr' is 'A[...]' for a variable or formal 'A'
+static Symbol* accessedArray(Expr* expr) {
+  CallExpr* call = toCallExpr(expr);
+
+  if (call == NULL || call->primitive != NULL || call->numActuals() == 0) {
+    return NULL;
+  }
+
+  if (SymExpr* base = toSymExpr(call->baseExpr)) {
+    Symbol* arr = base->symbol();
+
+    if ((isVarSymbol(arr) == true || isArgSymbol(arr) == true) &&
+        isShadowVarSymbol(arr) == false) {
+      return arr;
+    }
+  }
+
+  return NULL;
+}
+
+// 'arr' is declared outside 'fs' and this is its only mention in 'fs'
+static bool isOnlyReference(ForallStmt* fs, Symbol* arr) {
+  std::vector<SymExpr*> refs;
+
+  if (fs->contains(arr->defPoint) == true) {
+    return false;
+  }
+
+  collectSymExprsFor(fs, arr, refs);
+
+  return refs.size() == 1;
+}
+
+//
+// Adds the task-private aggregator 'prefix'+'arr' initialized by 'init'
+// and replaces 'stmt' with
+//
+//   if isAgg then aggregator.method(lhs, rhs); else stmt;
+//
+static void guardLastStmt(ForallStmt* fs, CallExpr* stmt,
+                          const char* prefix, Symbol* arr,
+                          CallExpr* init, CallExpr* isAgg,
+                          const char* method, Expr* lhs, Expr* rhs) {
+  const char*      name   = astr(prefix, arr->name);
+  ShadowVarSymbol* agg    = ShadowVarSymbol::buildForPrefix(SVP_VAR,
+                                              new UnresolvedSymExpr(name),
+                                              NULL,
+                                              init);
+  CallExpr*        update = new CallExpr(buildDotExpr(agg, method),
+                                         lhs->copy(),
+                                         rhs->copy());
+  CallExpr*        anchor = new CallExpr(PRIM_NOOP);
+
+  fs->shadowVariables().insertAtTail(agg->defPoint);
+
+  stmt->replace(anchor);
+  anchor->replace(buildIfStmt(isAgg, update, stmt));
+}
+
+//
+// --report-auto-aggregation, once resolution has chosen the branches
+//
+void reportAutoAggregation() {
+  size_t dstLen = strlen(kDstAggregatorPrefix);
+  size_t srcLen = strlen(kSrcAggregatorPrefix);
+
+  forv_Vec(ForallStmt, fs, gForallStmts) {
+    if (fs->inTree() == false || fs->getModule()->modTag != MOD_USER) {
+      continue;
+    }
+
+    for_shadow_vars(svar, temp, fs) {
+      const char* typeName = svar->type->symbol->name;
+
+      if (strncmp(svar->name, kDstAggregatorPrefix, dstLen) == 0 &&
+          startsWith(typeName, "chpl__DstAggregator")) {
+        USR_PRINT(fs,
+                  "updates to '%s' in this forall loop are aggregated",
+                  svar->name + dstLen);
+
+      } else if (strncmp(svar->name, kSrcAggregatorPrefix, srcLen) == 0 &&
+                 startsWith(typeName, "chpl__SrcAggregator")) {
+        USR_PRINT(fs,
+                  "reads of '%s' in this forall loop are aggregated",
+                  svar->name + srcLen);
+      }
+    }
+  }
+}
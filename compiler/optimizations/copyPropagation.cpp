@@ -22,6 +22,7 @@
 //
 #include "optimizations.h"
 
+#include "analysisManager.h"
 #include "astutil.h"
 #include "bb.h"
 #include "bitVec.h"
@@ -637,7 +638,7 @@ localCopyPropagationCore(BasicBlock*          bb,
 //
 size_t localCopyPropagation(FnSymbol* fn)
 {
-  BasicBlock::buildBasicBlocks(fn);
+  getBasicBlocks(fn);
   std::set<Symbol*> liveRefs;
 
   s_repl_count     = 0;
@@ -823,7 +824,7 @@ static void initInSets(std::vector<BitVec*>& IN, FnSymbol* fn)
 // immediately after it would be redundant.
 //
 size_t globalCopyPropagation(FnSymbol* fn) {
-  BasicBlock::buildBasicBlocks(fn);
+  getBasicBlocks(fn);
   std::set<Symbol*> liveRefs;
 
   size_t                     nbbs = fn->basicBlocks->size();
@@ -21,6 +21,7 @@
 
 #include "optimizations.h"
 
+#include "analysisManager.h"
 #include "astutil.h"
 #include "bb.h"
 #include "driver.h"
@@ -28,6 +29,7 @@
 #include "ForLoop.h"
 #include "ModuleSymbol.h"
 #include "passes.h"
+#include "runpasses.h"
 #include "stlUtil.h"
 #include "stmt.h"
 #include "WhileStmt.h"
@@ -38,7 +40,7 @@
 
 typedef std::set<BasicBlock*> BasicBlockSet;
 
-static void deadBlockElimination(FnSymbol* fn);
+static void buildReachableBlocks(FnSymbol* fn, size_t i, void* data);
 static void findReachableBlocks(FnSymbol* fn, BasicBlockSet& reachable);
 static void deleteUnreachableBlocks(FnSymbol* fn, BasicBlockSet& reachable);
 static bool         isInCForLoopHeader(Expr* expr);
@@ -487,15 +489,29 @@ void deadCodeElimination() {
   }
 }
 
+// Look for and remove unreachable blocks.  Finding the reachable blocks only
+// reads the AST, so that is done for all functions concurrently; the
+// unreachable blocks are then deleted one function at a time.
 void deadBlockElimination()
 {
   deadBlockCount = 0;
 
+  std::vector<FnSymbol*> fns;
+
   forv_Vec(FnSymbol, fn, gFnSymbols)
   {
-    if (!isAlive(fn))
-      continue;
-    deadBlockElimination(fn);
+    if (isAlive(fn))
+      fns.push_back(fn);
+  }
+
+  std::vector<BasicBlockSet> reachable(fns.size());
+
+  forEachFnConcurrently(fns, buildReachableBlocks, &reachable);
+
+  for (size_t i = 0; i < fns.size(); i++)
+  {
+    if (isAlive(fns[i]))
+      deleteUnreachableBlocks(fns[i], reachable[i]);
   }
 
   if (fReportDeadBlocks)
@@ -503,17 +519,17 @@ void deadBlockElimination()
 
 }
 
-// Look for and remove unreachable blocks.
-static void deadBlockElimination(FnSymbol* fn)
+static void buildReachableBlocks(FnSymbol* fn, size_t i, void* data)
 {
-  // We need the basic block information to be correct, so recompute it.
-  BasicBlock::buildBasicBlocks(fn);
+  std::vector<BasicBlockSet>* reachable =
+    static_cast<std::vector<BasicBlockSet>*>(data);
 
-  // Find the reachable basic blocks within this function.
-  BasicBlockSet reachable;
+  // We need the basic block information to be correct, so recompute it
+  // unless fn is unchanged since it was last computed.
+  getBasicBlocks(fn);
 
-  findReachableBlocks(fn, reachable);
-  deleteUnreachableBlocks(fn, reachable);
+  // Find the reachable basic blocks within this function.
+  findReachableBlocks(fn, (*reachable)[i]);
 }
 
 // Muchnick says we can enumerate the unreachable blocks first and then just
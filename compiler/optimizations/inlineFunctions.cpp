@@ -23,15 +23,19 @@
 #include "astutil.h"
 #include "driver.h"
 #include "expr.h"
+#include "files.h"
 #include "optimizations.h"
 #include "stlUtil.h"
 #include "stmt.h"
 #include "stringutil.h"
+#include "virtualDispatch.h"
 
+#include <map>
 #include <set>
 #include <vector>
 
 static void updateRefCalls();
+static void profileGuidedInlining();
 static void inlineFunctionsImpl();
 static void inlineFunction(FnSymbol* fn, std::set<FnSymbol*>& inlinedSet);
 static void inlineCall(CallExpr* call);
@@ -46,12 +50,20 @@ static void inlineCleanup();
 ************************************** | *************************************/
 
 void inlineFunctions() {
+  // Before chpl__delete and the owned methods are inlined into the
+  // code that allocates a class instance
+  stackAllocateClasses();
+
   convertToQualifiedRefs();
 
   compute_call_sites();
 
   updateRefCalls();
 
+  if (fProfileUse[0] != '\0') {
+    profileGuidedInlining();
+  }
+
   inlineFunctionsImpl();
 
   updateDerefCalls();
@@ -78,6 +90,193 @@ static void inlineFunctionsImpl() {
   }
 }
 
+/************************************* | **************************************
+*                                                                             *
+* --profile-use: mark functions inline or cold based on the call counts       *
+* written by a training run of the program compiled with --profile-gen, and   *
+* bind virtual calls that are dominated by one method to it.                  *
+*                                                                             *
+* The counts are keyed by FnSymbol id, which is stable as long as the         *
+* program is recompiled from the same sources with the same flags; the        *
+* recorded function names catch profiles that no longer match.                *
+*                                                                             *
+************************************** | *************************************/
+
+// A function is hot if it received at least 1/kHotCallFraction of the calls
+static const int64_t kHotCallFraction = 1000;
+
+// and small if its body makes at most this many calls
+static const size_t  kSmallFnCalls    = 16;
+
+struct ProfileEntry {
+  int64_t     calls;
+  const char* name;
+};
+
+static int64_t readProfile(std::map<int, ProfileEntry>& profile);
+static bool    isProfileInlineCandidate(FnSymbol* fn);
+static bool    reachesThroughInlined(FnSymbol*            fn,
+                                     FnSymbol*            target,
+                                     std::set<FnSymbol*>& visited);
+
+static void profileGuidedInlining() {
+  std::map<int, ProfileEntry>  profile;
+  std::map<FnSymbol*, int64_t> fnCalls;
+  int64_t                      totalCalls = readProfile(profile);
+  int                          numStale   = 0;
+
+  forv_Vec(FnSymbol, fn, gFnSymbols) {
+    std::map<int, ProfileEntry>::iterator it = profile.find(fn->id);
+
+    if (it == profile.end()) {
+      continue;
+
+    } else if (strcmp(it->second.name, fn->name) != 0) {
+      numStale++;
+
+    } else {
+      fnCalls[fn] = it->second.calls;
+    }
+  }
+
+  if (numStale > 0) {
+    USR_WARN("%d functions in profile '%s' do not match this program",
+             numStale,
+             fProfileUse);
+  }
+
+  speculativelyDevirtualize(fnCalls);
+
+  // The direct calls are new call sites
+  compute_call_sites();
+
+  forv_Vec(FnSymbol, fn, gFnSymbols) {
+    std::map<FnSymbol*, int64_t>::iterator it = fnCalls.find(fn);
+
+    if (it == fnCalls.end()) {
+      continue;
+    }
+
+    int64_t calls = it->second;
+
+    if (calls == 0) {
+      if (fn->hasFlag(FLAG_EXPORT) == false) {
+        fn->addFlag(FLAG_COLD_FN);
+      }
+
+    } else if (fNoInline == false &&
+               calls * kHotCallFraction >= totalCalls &&
+               isProfileInlineCandidate(fn) == true) {
+      std::set<FnSymbol*> visited;
+
+      fn->addFlag(FLAG_INLINE);
+
+      // Inlining requires the inline functions to be free of cycles
+      if (reachesThroughInlined(fn, fn, visited) == true) {
+        fn->removeFlag(FLAG_INLINE);
+
+      } else if (report_inlining) {
+        printf("chapel compiler: reporting inlining, "
+               "%s function is hot in the profile\n",
+               fn->cname);
+      }
+    }
+  }
+}
+
+// Returns the total number of calls
+static int64_t readProfile(std::map<int, ProfileEntry>& profile) {
+  FILE*   f          = openInputFile(fProfileUse);
+  int64_t totalCalls = 0;
+  int     lineno     = 0;
+  char    line[1024];
+
+  while (fgets(line, sizeof(line), f) != NULL) {
+    int          id    = 0;
+    long long    calls = 0;
+    char         name[1024];
+
+    lineno++;
+
+    if (line[0] == '#' || line[0] == '\n')
+      continue;
+
+    if (sscanf(line, "%d %lld %1023s", &id, &calls, name) != 3 || calls < 0) {
+      USR_FATAL("malformed line %d in profile '%s'", lineno, fProfileUse);
+    }
+
+    profile[id].calls = calls;
+    profile[id].name  = astr(name);
+
+    totalCalls += calls;
+  }
+
+  closeInputFile(f);
+
+  return totalCalls;
+}
+
+static bool isProfileInlineCandidate(FnSymbol* fn) {
+  std::vector<CallExpr*> calls;
+
+  // Later passes recognize calls to some internal module functions
+  // (e.g. the string literal factories), so leave those alone
+  if (fn->getModule()->modTag == MOD_INTERNAL) {
+    return false;
+  }
+
+  if (fn->hasFlag(FLAG_INLINE)                    == true  ||
+      fn->hasFlag(FLAG_EXTERN)                    == true  ||
+      fn->hasFlag(FLAG_EXPORT)                    == true  ||
+      fn->hasFlag(FLAG_VIRTUAL)                   == true  ||
+      fn->hasFlag(FLAG_NO_CODEGEN)                == true  ||
+      fn->hasFlag(FLAG_NEW_WRAPPER)               == true  ||
+      fn->hasFlag(FLAG_MODULE_INIT)               == true  ||
+      fn->hasFlag(FLAG_ON_BLOCK)                  == true  ||
+      fn->hasFlag(FLAG_BEGIN_BLOCK)               == true  ||
+      fn->hasFlag(FLAG_COBEGIN_OR_COFORALL_BLOCK) == true  ||
+      isTaskFun(fn)                               == true  ||
+      fn->calledBy->n                             == 0) {
+    return false;
+  }
+
+  // The function is removed once inlined, so it may only be called
+  for_SymbolSymExprs(se, fn) {
+    CallExpr* call = toCallExpr(se->parentExpr);
+
+    if (call == NULL || call->baseExpr != se) {
+      return false;
+    }
+  }
+
+  collectCallExprs(fn->body, calls);
+
+  return calls.size() <= kSmallFnCalls;
+}
+
+static bool reachesThroughInlined(FnSymbol*            fn,
+                                  FnSymbol*            target,
+                                  std::set<FnSymbol*>& visited) {
+  std::vector<CallExpr*> calls;
+
+  collectFnCalls(fn, calls);
+
+  for_vector(CallExpr, call, calls) {
+    if (FnSymbol* calledFn = call->resolvedFunction()) {
+      if (calledFn == target) {
+        return true;
+
+      } else if (calledFn->hasFlag(FLAG_INLINE)  == true &&
+                 visited.insert(calledFn).second == true &&
+                 reachesThroughInlined(calledFn, target, visited) == true) {
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
 /************************************* | **************************************
 *                                                                             *
 * Inline a function at every call site                                        *
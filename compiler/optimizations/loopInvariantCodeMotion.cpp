@@ -21,6 +21,7 @@
 
 #include "passes.h"
 
+#include "analysisManager.h"
 #include "astutil.h"
 #include "bb.h"
 #include "bitVec.h"
@@ -36,6 +37,7 @@
 #include "symbol.h"
 #include "timer.h"
 #include "optimizations.h"
+#include "runpasses.h"
 #include "WhileStmt.h"
 
 #include <algorithm>
@@ -114,11 +116,9 @@ public:
       delete bitExits;
     }
 
-    // This function exists to place an expr in the "preheader" of the loop
-    void insertBefore(Expr* expr) {
-      if (loopAST) {
-        loopAST->insertBefore(expr->remove());
-      }
+    // The AST of the loop, whose "preheader" hoisted exprs are placed in
+    LoopStmt* getLoopAST() {
+      return loopAST;
     }
 
     //Set the header, insert the header into the loop blocks, and build up the
@@ -756,6 +756,10 @@ static bool computeAliases(FnSymbol* fn, std::map<Symbol*, std::set<Symbol*> >&
   }
   stopTimer(computeAliasTimer);
 
+  return false;
+}
+
+static void reportAliases(FnSymbol* fn, std::map<Symbol*, std::set<Symbol*> >& aliases) {
   if (fReportAliases) {
     if (fn->getModule()->modTag == MOD_USER) {
       printf("LICM: may-alias report for a loop in function %s:\n", fn->name);
@@ -798,7 +802,6 @@ static bool computeAliases(FnSymbol* fn, std::map<Symbol*, std::set<Symbol*> >&
       }
     }
   }
-  return false;
 }
 
 /*
@@ -1166,29 +1169,39 @@ static bool canPerformCodeMotion(Loop* loop) {
  * hoisted before the loop(into a preheader of sorts) so long as they definition dominates
  * all uses in the loop, and the block that the definition is located in dominates all exits.
  */
-// This function returns the number of loops LICM'd
-static long licmFn(FnSymbol* fn) {
-  long numLoops = 0;
+//
+// What LICM found in one function: the exprs to move, each paired with
+// the loop it moves in front of, in the order they are to be moved.
+// Finding them only reads the AST, so it is done for all functions
+// concurrently; the moves themselves are made afterwards, in function
+// order.
+//
+struct LicmPlan {
+  long                                      numLoops;
+  std::vector<std::pair<LoopStmt*, Expr*> > hoists;
+
+  // Kept only to print the may-alias report once per loop considered.
+  int                                       numAliasReports;
+  std::map<Symbol*, std::set<Symbol*> >     aliases;
+};
+
+// Computes the hoists for fn into plan.
+static void licmAnalyzeFn(FnSymbol* fn, LicmPlan& plan) {
+  plan.numLoops        = 0;
+  plan.numAliasReports = 0;
+
   //build the basic blocks, where the first bb is the entry block
   startTimer(buildBBTimer);
 
-  BasicBlock::buildBasicBlocks(fn);
-
-  std::vector<BasicBlock*> basicBlocks = *fn->basicBlocks;
+  std::vector<BasicBlock*>& basicBlocks = getBasicBlocks(fn);
 
   BasicBlock* entryBlock = basicBlocks[0];
 
-  unsigned nBlocks = basicBlocks.size();
-
   stopTimer(buildBBTimer);
 
   //compute the dominators
   startTimer(computeDominatorTimer);
-  std::vector<BitVec*> dominators;
-  for(unsigned i = 0; i < nBlocks; i++) {
-    dominators.push_back(new BitVec(nBlocks));
-  }
-  computeDominators(dominators, basicBlocks);
+  std::vector<BitVec*>& dominators = getDominators(fn);
   stopTimer(computeDominatorTimer);
 
   //Collect all of the loops
@@ -1197,6 +1210,12 @@ static long licmFn(FnSymbol* fn) {
   collectNaturalLoops(loops, basicBlocks, entryBlock, dominators);
   stopTimer(collectNaturalLoopsTimer);
 
+  //The aliases only depend on the function, so they are computed once, when
+  //the first loop that might be hoisted from needs them
+  std::map<Symbol*, std::set<Symbol*> >& aliases = plan.aliases;
+  bool computedAliases = false;
+  bool tooManyAliases = false;
+
   //For each loop found
   for_vector(Loop, curLoop, loops) {
 
@@ -1221,11 +1240,15 @@ static long licmFn(FnSymbol* fn) {
     startTimer(computeLoopInvariantsTimer);
     std::vector<SymExpr*> loopInvariants;
     std::set<Symbol*> defsInLoop;
-    std::map<Symbol*, std::set<Symbol*> > aliases;
-    bool tooManyAlises = computeAliases(fn, aliases);
-    if (tooManyAlises) {
-      return 0;
+    if (computedAliases == false) {
+      tooManyAliases = computeAliases(fn, aliases);
+      computedAliases = true;
+    }
+    if (tooManyAliases) {
+      freeLocalDefUseMaps(localDefMap, localUseMap);
+      break;
     }
+    plan.numAliasReports++;
     computeLoopInvariants(loopInvariants, defsInLoop, curLoop, localDefMap, aliases);
     stopTimer(computeLoopInvariantsTimer);
 
@@ -1234,10 +1257,12 @@ static long licmFn(FnSymbol* fn) {
       if(CallExpr* call = toCallExpr(symExpr->parentExpr)) {
         if(defDominatesAllUses(curLoop, symExpr, dominators, localMap, localUseMap)) {
           if(defDominatesAllExits(curLoop, symExpr, dominators, localMap)) {
-            if(defsInLoop.count(symExpr->symbol()) == 1) {
-              curLoop->insertBefore(symExpr->symbol()->defPoint);
+            if (LoopStmt* loopAST = curLoop->getLoopAST()) {
+              if(defsInLoop.count(symExpr->symbol()) == 1) {
+                plan.hoists.push_back(std::make_pair(loopAST, symExpr->symbol()->defPoint));
+              }
+              plan.hoists.push_back(std::make_pair(loopAST, call));
             }
-            curLoop->insertBefore(call);
           }
         }
       }
@@ -1245,19 +1270,331 @@ static long licmFn(FnSymbol* fn) {
 
     freeLocalDefUseMaps(localDefMap, localUseMap);
   }
-  numLoops += loops.size();
+
+  if (tooManyAliases) {
+    //nothing is hoisted from a function with too many aliases
+    plan.hoists.clear();
+    plan.numAliasReports = 0;
+  } else {
+    plan.numLoops += loops.size();
+  }
+
+  if (fReportAliases == false) {
+    aliases.clear();
+  }
 
   for_vector(Loop, loop, loops) {
     delete loop;
     loop = 0;
   }
+}
+
+static void licmAnalyze(FnSymbol* fn, size_t i, void* data) {
+  std::vector<LicmPlan>* plans = static_cast<std::vector<LicmPlan>*>(data);
+
+  licmAnalyzeFn(fn, (*plans)[i]);
+}
+
+// Places the hoisted exprs in the "preheaders" of their loops and returns the
+// number of loops LICM'd
+static long licmApplyFn(FnSymbol* fn, LicmPlan& plan) {
+  for (int i = 0; i < plan.numAliasReports; i++) {
+    reportAliases(fn, plan.aliases);
+  }
+
+  for (size_t i = 0; i < plan.hoists.size(); i++) {
+    LoopStmt* loopAST = plan.hoists[i].first;
+    Expr*     expr    = plan.hoists[i].second;
 
-  for_vector(BitVec, bitVec, dominators) {
-    delete bitVec;
-    bitVec = 0;
+    loopAST->insertBefore(expr->remove());
   }
 
-  return numLoops;
+  return plan.numLoops;
+}
+
+/************************************* | **************************************
+*                                                                             *
+* Array descriptor hoisting                                                   *
+*                                                                             *
+* An access A[i,j] to a DefaultRectangularArr reloads A's _instance and the   *
+* instance's blk/off/str/factoredOffs/shiftedData fields on every iteration.  *
+* The LICM above cannot move these because A is usually a ref formal or a     *
+* module-level variable.  These fields only change when the array is          *
+* reallocated, which takes a call, so in a loop without such calls the loads  *
+* are invariant once their base is.  Hoisting them (and the elements of the   *
+* blk/off/str tuples) leaves the index an affine function of the loop         *
+* indices, which the back-end compiler strength-reduces into pointer          *
+* increments.                                                                 *
+*                                                                             *
+************************************** | *************************************/
+
+static bool isInLoop(Expr* expr, LoopStmt* loop) {
+  for (Expr* e = expr; e != NULL; e = e->parentExpr) {
+    if (e == loop)
+      return true;
+  }
+  return false;
+}
+
+// Instantiations are renamed after the array type, e.g. '[D] real'
+static bool isDefaultRectangularArr(Type* type) {
+  AggregateType* at = toAggregateType(type);
+
+  return at != NULL &&
+         strcmp(at->getRootInstantiation()->symbol->name,
+                "DefaultRectangularArr") == 0;
+}
+
+static bool isArrayDescriptorField(Symbol* field) {
+  TypeSymbol* ts = toTypeSymbol(field->defPoint->parentSymbol);
+
+  if (ts == NULL) {
+    return false;
+  } else if (ts->hasFlag(FLAG_ARRAY)) {
+    return strcmp(field->name, "_instance") == 0;
+  } else if (isDefaultRectangularArr(ts->type)) {
+    return strcmp(field->name, "blk")          == 0 ||
+           strcmp(field->name, "off")          == 0 ||
+           strcmp(field->name, "str")          == 0 ||
+           strcmp(field->name, "factoredOffs") == 0 ||
+           strcmp(field->name, "shiftedData")  == 0 ||
+           strcmp(field->name, "data")         == 0;
+  }
+
+  return false;
+}
+
+// Could 'se' change the value of its symbol, or of what it refers to?
+static bool isWrite(SymExpr* se) {
+  CallExpr* call = toCallExpr(se->parentExpr);
+
+  if (call == NULL)
+    return false;
+
+  if (call->isPrimitive(PRIM_MOVE) || call->isPrimitive(PRIM_ASSIGN) ||
+      isOpEqualPrim(call) ||
+      call->isPrimitive(PRIM_SET_MEMBER) ||
+      call->isPrimitive(PRIM_SET_SVEC_MEMBER))
+    return call->get(1) == se;
+
+  return call->isPrimitive(PRIM_ADDR_OF) ||
+         call->isPrimitive(PRIM_SET_REFERENCE) ||
+         call->isPrimitive(PRIM_VIRTUAL_METHOD_CALL) ||
+         call->isResolved();
+}
+
+static bool isInvariantIn(Symbol* sym, LoopStmt* loop) {
+  if (isInLoop(sym->defPoint, loop))
+    return false;
+
+  for_SymbolSymExprs(se, sym) {
+    if (isInLoop(se, loop) && isWrite(se))
+      return false;
+  }
+
+  return true;
+}
+
+// Is 'sym' only ever read, apart from its definition 'def'?
+static bool isReadOnlyTemp(Symbol* sym, SymExpr* def) {
+  if (!isVarSymbol(sym) || !sym->hasFlag(FLAG_TEMP))
+    return false;
+
+  for_SymbolSymExprs(se, sym) {
+    if (se != def && isWrite(se))
+      return false;
+  }
+
+  return true;
+}
+
+// Could anything in the loop reallocate an array, write a descriptor
+// field, or leave the loop early?
+static bool mayChangeArrayDescriptors(LoopStmt* loop) {
+  std::vector<GotoStmt*> gotos;
+  collectGotoStmts(loop, gotos);
+
+  if (gotos.size() > 0)
+    return true;
+
+  std::vector<CallExpr*> calls;
+  collectCallExprs(loop, calls);
+
+  for_vector(CallExpr, call, calls) {
+    if (FnSymbol* fn = call->resolvedFunction()) {
+      if (!fn->hasFlag(FLAG_FUNCTION_TERMINATES_PROGRAM) &&
+          !fn->hasFlag(FLAG_EXTERN))
+        return true;
+
+    } else if (call->isPrimitive(PRIM_VIRTUAL_METHOD_CALL)) {
+      return true;
+
+    } else if (call->isPrimitive(PRIM_SET_MEMBER)) {
+      if (isArrayDescriptorField(toSymExpr(call->get(2))->symbol()))
+        return true;
+
+    } else if (call->isPrimitive(PRIM_GET_MEMBER)) {
+      // A reference to a descriptor field must only be read through
+      CallExpr* move = toCallExpr(call->parentExpr);
+      SymExpr* field = toSymExpr(call->get(2));
+
+      if (field && isArrayDescriptorField(field->symbol())) {
+        if (move == NULL || !move->isPrimitive(PRIM_MOVE))
+          return true;
+
+        SymExpr* lhs = toSymExpr(move->get(1));
+
+        if (!isReadOnlyTemp(lhs->symbol(), lhs))
+          return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+// Is 'call' a read of a constant element of a hoisted blk/off/str tuple?
+static bool isHoistedElementRead(CallExpr* call, std::set<Symbol*>& hoisted) {
+  if (call->numActuals() != 2)
+    return false;
+
+  SymExpr* base = toSymExpr(call->get(1));
+  SymExpr* elt = toSymExpr(call->get(2));
+
+  if (base == NULL || elt == NULL || hoisted.count(base->symbol()) == 0)
+    return false;
+
+  if (call->isPrimitive(PRIM_GET_SVEC_MEMBER_VALUE))
+    return elt->symbol()->isImmediate();
+
+  if (call->isPrimitive(PRIM_GET_MEMBER_VALUE))
+    return base->symbol()->getValType()->symbol->hasFlag(FLAG_TUPLE);
+
+  return false;
+}
+
+// Is 'stmt' 'move tmp, load' where the load reads an array descriptor
+// field, a copy, or an element of a descriptor tuple, all from bases
+// that are invariant in the loop?
+static bool isHoistableDescriptorLoad(Expr* stmt,
+                                      LoopStmt* loop,
+                                      std::set<Symbol*>& hoisted) {
+  CallExpr* move = toCallExpr(stmt);
+
+  if (move == NULL || !move->isPrimitive(PRIM_MOVE))
+    return false;
+
+  SymExpr* lhs = toSymExpr(move->get(1));
+
+  if (lhs->isWideRef() || !isReadOnlyTemp(lhs->symbol(), lhs))
+    return false;
+
+  if (SymExpr* rhs = toSymExpr(move->get(2)))
+    return hoisted.count(rhs->symbol()) > 0;
+
+  CallExpr* load = toCallExpr(move->get(2));
+
+  if (load == NULL)
+    return false;
+
+  if (isHoistedElementRead(load, hoisted))
+    return true;
+
+  if (load->isPrimitive(PRIM_GET_MEMBER_VALUE) ||
+      load->isPrimitive(PRIM_GET_MEMBER)) {
+    SymExpr* base = toSymExpr(load->get(1));
+    SymExpr* field = toSymExpr(load->get(2));
+
+    return base != NULL && field != NULL &&
+           !base->isWideRef() &&
+           !base->symbol()->type->symbol->hasFlag(FLAG_WIDE_CLASS) &&
+           isArrayDescriptorField(field->symbol()) &&
+           (hoisted.count(base->symbol()) > 0 ||
+            isInvariantIn(base->symbol(), loop));
+  }
+
+  return false;
+}
+
+// Gather the statements of 'block' that run on every pass through it,
+// looking into the plain blocks left behind by inlining
+static void collectStraightLineStmts(BlockStmt* block,
+                                     std::vector<Expr*>& stmts) {
+  for_alist(stmt, block->body) {
+    BlockStmt* inner = toBlockStmt(stmt);
+
+    if (inner != NULL &&
+        !inner->isLoopStmt() &&
+        (inner->blockTag & ~BLOCK_SCOPELESS) == 0 &&
+        inner->blockInfoGet() == NULL)
+      collectStraightLineStmts(inner, stmts);
+    else
+      stmts.push_back(stmt);
+  }
+}
+
+static void hoistArrayDescriptors(LoopStmt* loop) {
+  if (mayChangeArrayDescriptors(loop))
+    return;
+
+  std::set<Symbol*> hoisted;
+  std::vector<Expr*> stmts;
+
+  collectStraightLineStmts(loop, stmts);
+
+  // Loads of a chain come in order, so one pass moves the whole chain
+  for_vector(Expr, stmt, stmts) {
+    if (isHoistableDescriptorLoad(stmt, loop, hoisted)) {
+      CallExpr* move = toCallExpr(stmt);
+      Symbol* tmp = toSymExpr(move->get(1))->symbol();
+
+      if (isInLoop(tmp->defPoint, loop))
+        loop->insertBefore(tmp->defPoint->remove());
+
+      loop->insertBefore(move->remove());
+      hoisted.insert(tmp);
+    }
+  }
+
+  if (hoisted.size() == 0)
+    return;
+
+  // Tuple elements read within larger expressions, e.g. 'i * blk(0)'
+  std::map<std::pair<Symbol*, Symbol*>, VarSymbol*> elements;
+  std::vector<CallExpr*> calls;
+  collectCallExprs(loop, calls);
+
+  for_vector(CallExpr, call, calls) {
+    if (call->inTree() && isHoistedElementRead(call, hoisted)) {
+      SET_LINENO(call);
+      std::pair<Symbol*, Symbol*> key(toSymExpr(call->get(1))->symbol(),
+                                      toSymExpr(call->get(2))->symbol());
+      VarSymbol* elt = elements[key];
+
+      if (elt == NULL) {
+        elt = newTemp("descriptor_elt", call->typeInfo());
+        elements[key] = elt;
+        loop->insertBefore(new DefExpr(elt));
+        loop->insertBefore(new CallExpr(PRIM_MOVE, elt, call->copy()));
+      }
+
+      call->replace(new SymExpr(elt));
+    }
+  }
+}
+
+static void hoistArrayDescriptors(FnSymbol* fn) {
+  std::vector<BaseAST*> asts;
+
+  // Inner loops come first, so what they hoist can move on out
+  collect_asts_postorder(fn->body, asts);
+
+  for_vector(BaseAST, ast, asts) {
+    if (LoopStmt* loop = toLoopStmt(ast)) {
+      if (loop->isCForLoop() || loop->isWhileStmt())
+        hoistArrayDescriptors(loop);
+    }
+  }
 }
 
 void loopInvariantCodeMotion(void) {
@@ -1275,9 +1612,20 @@ void loopInvariantCodeMotion(void) {
   startTimer(overallTimer);
   long numLoops = 0;
 
-  //TODO use stl routine here
+  std::vector<FnSymbol*> fns;
   forv_Vec(FnSymbol, fn, gFnSymbols) {
-    numLoops += licmFn(fn);
+    fns.push_back(fn);
+  }
+
+  std::vector<LicmPlan> plans(fns.size());
+  forEachFnConcurrently(fns, licmAnalyze, &plans);
+
+  for (size_t i = 0; i < fns.size(); i++) {
+    numLoops += licmApplyFn(fns[i], plans[i]);
+  }
+
+  for_vector(FnSymbol, fn, fns) {
+    hoistArrayDescriptors(fn);
   }
 
   stopTimer(overallTimer);
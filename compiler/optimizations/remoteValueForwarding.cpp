@@ -27,6 +27,7 @@
 #include "stlUtil.h"
 #include "stmt.h"
 #include "stringutil.h"
+#include "wellknown.h"
 
 //#define DEBUG_SYNC_ACCESS_FUNCTION_SET
 
@@ -57,6 +58,8 @@ typedef std::map<Symbol*, DotInfo*>::iterator DotInfoIter;
 
 static void computeUsesDotLocale();
 
+static void forwardFieldReads();
+
 /************************************* | **************************************
 *                                                                             *
 * Convert reference args into values if they are only read and reading them   *
@@ -83,6 +86,8 @@ void remoteValueForwarding() {
 
     freeDefUseMaps(defMap, useMap);
 
+    forwardFieldReads();
+
     for (DotInfoIter it = dotLocaleMap.begin(); it != dotLocaleMap.end(); ++it) {
       delete it->second;
     }
@@ -1010,3 +1015,523 @@ static void computeUsesDotLocale() {
     computeDotLocale(sym);
   }
 }
+
+/************************************* | **************************************
+*                                                                             *
+* Forward reads of read-only fields into on-statements.                       *
+*                                                                             *
+* After the formals of an on-statement have been forwarded, the body may      *
+* still reach through them into objects on the original locale, e.g.         *
+*                                                                             *
+*   on loc do use(cfg.field.subfield);                                        *
+*                                                                             *
+* where every field access is a remote GET. When the fields along such a     *
+* path can't change, read the value before the on-statement and pass it in   *
+* as another formal. Values forwarded this way are themselves roots, so      *
+* paths through several objects are forwarded one field at a time.           *
+*                                                                             *
+************************************** | *************************************/
+
+// Upper bound on the number of bytes added to an on-statement's arguments.
+static const int maxForwardedFieldBytes = 256;
+
+static std::map<Symbol*, bool> readOnlyFieldMap;
+
+static std::map<Symbol*, const char*> forwardedPathMap;
+
+//
+// Returns the field returned by a compiler-generated accessor that can be
+// used to read it, i.e. one whose body only takes the address of the field.
+// Record field accessors return a const ref when 'this' is const.
+//
+static Symbol* accessorField(FnSymbol* fn) {
+  if (fn == NULL                                                  ||
+      !fn->hasFlag(FLAG_FIELD_ACCESSOR)                           ||
+      (fn->retTag != RET_CONST_REF &&
+       !fn->hasFlag(FLAG_REF_TO_CONST_WHEN_CONST_THIS))           ||
+      fn->_this == NULL) {
+    return NULL;
+  }
+
+  Symbol* field = NULL;
+  std::vector<CallExpr*> calls;
+
+  collectCallExprs(fn->body, calls);
+
+  for_vector(CallExpr, call, calls) {
+    if (call->isPrimitive(PRIM_GET_MEMBER)) {
+      SymExpr* base = toSymExpr(call->get(1));
+
+      if (field != NULL || base == NULL || base->symbol() != fn->_this) {
+        return NULL;
+      }
+      field = toSymExpr(call->get(2))->symbol();
+
+    } else if (!call->isPrimitive(PRIM_MOVE) &&
+               !call->isPrimitive(PRIM_RETURN)) {
+      return NULL;
+    }
+  }
+
+  return field;
+}
+
+static bool isInitOrDeinitOf(FnSymbol* fn, Symbol* field) {
+  if (fn->_this == NULL ||
+      fn->_this->getValType() != field->defPoint->parentSymbol->type) {
+    return false;
+  }
+
+  return strcmp(fn->name, "init")     == 0 ||
+         strcmp(fn->name, "init=")    == 0 ||
+         strcmp(fn->name, "postinit") == 0 ||
+         strcmp(fn->name, "deinit")   == 0;
+}
+
+//
+// A field is read-only if it is declared const or if, apart from its type's
+// initializers and deinitializer, it is only read.
+//
+static bool isReadOnlyField(Symbol* field) {
+  std::map<Symbol*, bool>::iterator it = readOnlyFieldMap.find(field);
+
+  if (it != readOnlyFieldMap.end()) {
+    return it->second;
+  }
+
+  bool retval = true;
+
+  if (field->isConstant() == false) {
+    for_SymbolSymExprs(se, field) {
+      CallExpr* call = toCallExpr(se->parentExpr);
+      FnSymbol* fn   = se->getFunction();
+
+      if (call == NULL || fn == NULL) {
+        retval = false;
+
+      } else if (call->isPrimitive(PRIM_GET_MEMBER_VALUE)) {
+        // A read
+
+      } else if (call->isPrimitive(PRIM_GET_MEMBER) ||
+                 call->isPrimitive(PRIM_SET_MEMBER)) {
+        if (isInitOrDeinitOf(fn, field) == false &&
+            (fn->retTag != RET_CONST_REF ||
+             accessorField(fn) != field)         &&
+            (fn->hasFlag(FLAG_FIELD_ACCESSOR) == false ||
+             fn->isUsed()                     == true)) {
+          retval = false;
+        }
+
+      } else {
+        retval = false;
+      }
+
+      if (retval == false) {
+        break;
+      }
+    }
+  }
+
+  readOnlyFieldMap[field] = retval;
+
+  return retval;
+}
+
+//
+// Is this statement executed whenever 'fn' is?
+//
+static bool isUnconditional(Expr* stmt, FnSymbol* fn) {
+  for (Expr* expr = stmt->parentExpr; expr != fn->body; expr = expr->parentExpr) {
+    BlockStmt* block = toBlockStmt(expr);
+
+    if (block == NULL || block->isLoopStmt() ||
+        isCondStmt(block->parentExpr) || block->blockInfoGet() != NULL) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+//
+// Returns the only move into 'sym', or NULL if there isn't exactly one or
+// the value may also be modified through a reference. Passing a reference
+// symbol to a ref formal doesn't rebind it, so that isn't a definition.
+//
+static CallExpr* findSingleMove(Symbol* sym) {
+  CallExpr* retval = NULL;
+
+  for_SymbolSymExprs(se, sym) {
+    CallExpr* call = toCallExpr(se->parentExpr);
+
+    if (call != NULL &&
+        (call->isPrimitive(PRIM_MOVE) || call->isPrimitive(PRIM_ASSIGN)) &&
+        call->get(1) == se) {
+      if (retval != NULL || !call->isPrimitive(PRIM_MOVE)) {
+        return NULL;
+      }
+      retval = call;
+
+    } else if (!sym->isRef() && (isDefAndOrUse(se) & 1)) {
+      return NULL;
+    }
+  }
+
+  return retval;
+}
+
+//
+// Returns true if the value of 'sym' can be computed before the call to the
+// on-statement 'fn', i.e. it is a forwarded formal or only depends on such
+// formals through moves, dereferences and const field accessors. 'remote'
+// is set if computing it reads a field of a class.
+//
+static bool isForwardable(FnSymbol*              fn,
+                          Symbol*                sym,
+                          std::set<Symbol*>&     targets,
+                          bool&                  remote) {
+  if (ArgSymbol* arg = toArgSymbol(sym)) {
+      return arg->defPoint->parentSymbol == fn &&
+           arg->isRef()                 == false &&
+           arg->isDefined()             == false &&
+           targets.count(arg)           == 0;
+  }
+
+  if (!isVarSymbol(sym) || sym->defPoint->parentSymbol != fn) {
+    return false;
+  }
+
+  CallExpr* move = findSingleMove(sym);
+  if (move == NULL || !isUnconditional(move, fn)) {
+    return false;
+  }
+
+  Expr* rhs = move->get(2);
+
+  if (SymExpr* se = toSymExpr(rhs)) {
+    return se->qualType().type() == sym->qualType().type() &&
+           isForwardable(fn, se->symbol(), targets, remote);
+  }
+
+  CallExpr* call = toCallExpr(rhs);
+  if (call == NULL) {
+    return false;
+  }
+
+  if (call->isPrimitive(PRIM_DEREF) || call->isPrimitive(PRIM_SET_REFERENCE)) {
+    SymExpr* se = toSymExpr(call->get(1));
+    return se != NULL && isForwardable(fn, se->symbol(), targets, remote);
+  }
+
+  if (Symbol* field = accessorField(call->resolvedFunction())) {
+    SymExpr* base = toSymExpr(call->get(1));
+
+    if (call->numActuals() != 1 || base == NULL) {
+      return false;
+    }
+
+    if (isClass(base->getValType())) {
+      if (call->resolvedFunction()->retTag != RET_CONST_REF ||
+          isReadOnlyField(field)               == false) {
+        return false;
+      }
+      remote = true;
+    }
+
+    return isForwardable(fn, base->symbol(), targets, remote);
+  }
+
+  return false;
+}
+
+//
+// The number of bytes it takes to forward a value of this type, or -1 if it
+// may not be copied into the on-statement bitwise.
+//
+static int forwardedSize(Type* t) {
+  TypeSymbol* ts = t->symbol;
+
+  if (ts->hasFlag(FLAG_EXTERN)      ||
+      ts->hasFlag(FLAG_C_PTR_CLASS) ||
+      ts->hasFlag(FLAG_DATA_CLASS)  ||
+      ts->hasFlag(FLAG_REF)         ||
+      isSyncType(t)                 ||
+      isSingleType(t)               ||
+      isAtomicType(t)) {
+    return -1;
+
+  } else if (is_bool_type(t) || is_int_type(t)  || is_uint_type(t) ||
+             is_real_type(t) || is_imag_type(t) || is_enum_type(t)) {
+    return 8;
+
+  } else if (is_complex_type(t)) {
+    return 16;
+
+  } else if (isClass(t)) {
+    // Class references are wide when they cross an on-statement.
+    return 16;
+
+  } else if (AggregateType* at = toAggregateType(t)) {
+    if (at->isRecord()) {
+      int size = 0;
+
+      for_fields(field, at) {
+        int fieldSize = forwardedSize(field->type);
+
+        if (fieldSize < 0 || field->isRef()) {
+          return -1;
+        }
+        size += fieldSize;
+      }
+
+      return size;
+    }
+  }
+
+  return -1;
+}
+
+//
+// Is 'ref' only read by the on-statement body?
+//
+static bool isOnlyRead(Symbol* ref, FnSymbol* fn) {
+  bool retval = ref->isUsed();
+
+  for_SymbolSymExprs(se, ref) {
+    CallExpr* call = toCallExpr(se->parentExpr);
+
+    if (call == NULL || !isUnconditional(call->getStmtExpr(), fn)) {
+      retval = false;
+
+    } else if (call->isPrimitive(PRIM_MOVE) && call->get(1) == se) {
+      // The definition
+
+    } else if (call->isPrimitive(PRIM_DEREF)) {
+      // A read
+
+    } else if (FnSymbol* callee = call->resolvedFunction()) {
+      ArgSymbol* formal = actual_to_formal(se);
+
+      if (accessorField(callee) != NULL ||
+          (formal->intent & INTENT_FLAG_CONST) == 0) {
+        retval = false;
+      }
+
+    } else {
+      retval = false;
+    }
+
+    if (retval == false) {
+      break;
+    }
+  }
+
+  return retval;
+}
+
+//
+// Build the expression to compute 'sym' before a call to the on-statement.
+//
+static Symbol* buildForwardedValue(CallExpr*                  call,
+                                   Symbol*                    sym,
+                                   std::map<Symbol*, Symbol*>& built) {
+  if (built.count(sym) != 0) {
+    return built[sym];
+  }
+
+  Symbol* retval = NULL;
+
+  if (ArgSymbol* arg = toArgSymbol(sym)) {
+    retval = toSymExpr(formal_to_actual(call, arg))->symbol();
+
+  } else {
+    CallExpr* move = findSingleMove(sym);
+    Expr*     rhs  = move->get(2);
+
+    if (SymExpr* se = toSymExpr(rhs)) {
+      retval = buildForwardedValue(call, se->symbol(), built);
+
+    } else {
+      CallExpr* value = toCallExpr(rhs)->copy();
+      SymExpr*  base  = toSymExpr(value->get(1));
+      VarSymbol* tmp  = newTemp("rvfFieldTmp", sym->qualType());
+
+      base->setSymbol(buildForwardedValue(call, base->symbol(), built));
+
+      call->insertBefore(new DefExpr(tmp));
+      call->insertBefore(new CallExpr(PRIM_MOVE, tmp, value));
+
+      retval = tmp;
+    }
+  }
+
+  built[sym] = retval;
+
+  return retval;
+}
+
+static const char* forwardedPath(Symbol* sym) {
+  if (forwardedPathMap.count(sym) != 0) {
+    return forwardedPathMap[sym];
+
+  } else if (isArgSymbol(sym)) {
+    return sym->name;
+  }
+
+  CallExpr* move = findSingleMove(sym);
+  Expr*     rhs  = move->get(2);
+
+  if (SymExpr* se = toSymExpr(rhs)) {
+    return forwardedPath(se->symbol());
+  }
+
+  CallExpr* call = toCallExpr(rhs);
+  Symbol*   base = toSymExpr(call->get(1))->symbol();
+
+  if (Symbol* field = accessorField(call->resolvedFunction())) {
+    return astr(forwardedPath(base), ".", field->name);
+  }
+
+  return forwardedPath(base);
+}
+
+//
+// The symbols the on-statement's locale is computed from ('obj' in
+// 'on obj'). Paths through them are not forwarded, since the body
+// runs where they live.
+//
+static Symbol* sourceOf(Symbol* sym) {
+  while (CallExpr* move = findSingleMove(sym)) {
+    Expr* rhs = move->get(2);
+    if (CallExpr* call = toCallExpr(rhs)) {
+      FnSymbol* callee = call->resolvedFunction();
+      if (call->isPrimitive(PRIM_DEREF) ||
+          (callee && (callee->hasFlag(FLAG_INIT_COPY_FN) ||
+                      callee->hasFlag(FLAG_AUTO_COPY_FN)))) {
+        rhs = call->get(1);
+      }
+    }
+
+    SymExpr* se = toSymExpr(rhs);
+    if (se == NULL) break;
+    sym = se->symbol();
+  }
+
+  return sym;
+}
+
+static void findOnTargets(FnSymbol* fn, std::set<Symbol*>& targets) {
+  ArgSymbol* localeArg = fn->getFormal(1);
+
+  if (localeArg == NULL || localeArg->type != dtLocaleID) {
+    return;
+  }
+
+  forv_Vec(CallExpr, call, *fn->calledBy) {
+    SymExpr* locale = toSymExpr(formal_to_actual(call, localeArg));
+    Symbol*  target = NULL;
+
+    if (locale != NULL) {
+      if (CallExpr* move = findSingleMove(sourceOf(locale->symbol()))) {
+        CallExpr* rhs = toCallExpr(move->get(2));
+
+        if (rhs != NULL && rhs->isPrimitive(PRIM_WIDE_GET_LOCALE)) {
+          if (SymExpr* se = toSymExpr(rhs->get(1))) {
+            target = sourceOf(se->symbol());
+          }
+        }
+      }
+    }
+
+    if (target != NULL) {
+      for_formals(formal, fn) {
+        SymExpr* actual = toSymExpr(formal_to_actual(call, formal));
+
+        if (actual != NULL && sourceOf(actual->symbol()) == target) {
+          targets.insert(formal);
+        }
+      }
+    }
+  }
+}
+
+static void forwardFieldReads(FnSymbol* fn) {
+  std::set<Symbol*> targets;
+  int               budget  = maxForwardedFieldBytes;
+  bool              changed = true;
+
+  findOnTargets(fn, targets);
+
+  while (changed) {
+    std::vector<CallExpr*> calls;
+
+    changed = false;
+
+    collectCallExprs(fn->body, calls);
+
+    for_vector(CallExpr, move, calls) {
+      if (!move->isPrimitive(PRIM_MOVE)) continue;
+
+      SymExpr*  lhs      = toSymExpr(move->get(1));
+      CallExpr* accessor = toCallExpr(move->get(2));
+      Symbol*   ref      = lhs->symbol();
+      bool      remote   = false;
+
+      if (accessor == NULL                                           ||
+          accessorField(accessor->resolvedFunction()) == NULL   ||
+          ref->isRef()                                     == false  ||
+          isForwardable(fn, ref, targets, remote)          == false  ||
+          remote                                           == false  ||
+          isOnlyRead(ref, fn)                              == false) {
+        continue;
+      }
+
+      Type* valType = ref->getValType();
+      int   size    = forwardedSize(valType);
+
+      if (size < 0 || size > budget) {
+        continue;
+      }
+
+      SET_LINENO(move);
+
+      const char* path   = forwardedPath(ref);
+      ArgSymbol*  formal = new ArgSymbol(INTENT_CONST_IN, "rvfFieldTmp", valType);
+
+      forv_Vec(CallExpr, call, *fn->calledBy) {
+        std::map<Symbol*, Symbol*> built;
+        Symbol*    addr  = buildForwardedValue(call, ref, built);
+        VarSymbol* value = newTemp("rvfFieldTmp", valType);
+
+        call->insertBefore(new DefExpr(value));
+        call->insertBefore(new CallExpr(PRIM_MOVE, value,
+                                        new CallExpr(PRIM_DEREF, addr)));
+        call->insertAtTail(value);
+      }
+
+      fn->insertFormalAtTail(new DefExpr(formal));
+      forwardedPathMap[formal] = path;
+
+      accessor->replace(new CallExpr(PRIM_SET_REFERENCE, formal));
+
+      if (fReportForwardedFields && fn->getModule()->modTag == MOD_USER) {
+        USR_PRINT(move, "'%s' is read before the on-statement and "
+                  "forwarded into it", path);
+      }
+
+      budget  -= size;
+      changed  = true;
+    }
+  }
+}
+
+static void forwardFieldReads() {
+  forv_Vec(FnSymbol, fn, gFnSymbols) {
+    if (fn->hasFlag(FLAG_ON) && fn->calledBy->n > 0) {
+      forwardFieldReads(fn);
+    }
+  }
+
+  readOnlyFieldMap.clear();
+  forwardedPathMap.clear();
+}
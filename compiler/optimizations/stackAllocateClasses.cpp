@@ -0,0 +1,454 @@
+/*
+ * Copyright 2020 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "optimizations.h"
+
+#include "astlocs.h"
+#include "astutil.h"
+#include "DecoratedClassType.h"
+#include "driver.h"
+#include "expr.h"
+#include "stlUtil.h"
+#include "stmt.h"
+#include "stringutil.h"
+#include "symbol.h"
+#include "type.h"
+
+#include <map>
+#include <set>
+#include <vector>
+
+/************************************* | **************************************
+*                                                                             *
+* Stack allocation of class instances that do not escape.                     *
+*                                                                             *
+* 'new C(...)' calls a _new wrapper that gets its memory from                 *
+* chpl_here_alloc.  When every alias of the new instance -- the temps it is   *
+* moved through, the owned records that manage it, the borrows taken from    *
+* them and references to its fields -- is a local of the block that creates  *
+* it, and none of them is stored, returned or handed to a task, the instance *
+* dies with that block.  Such instances get their memory from                 *
+* PRIM_STACK_ALLOCATE_CLASS instead, and the 'delete' or owned destructor     *
+* that would free them only runs the class's deinit.                          *
+*                                                                             *
+* Lifetime checking has already made sure that borrows do not outlive their  *
+* owned; this analysis additionally follows the object through calls, so a   *
+* callee that only reads fields or calls non-escaping methods keeps it on    *
+* the stack.  The answer for each (function, formal) pair is cached.         *
+*                                                                             *
+************************************** | *************************************/
+
+enum EscapeKind {
+  ESCAPE_NONE,      // the formal does not outlive the call
+  ESCAPE_RETURNED,  // only through the return value
+  ESCAPE_ANY
+};
+
+// Limits how deep the analysis follows the object into callees
+static const int kMaxCallDepth = 8;
+
+struct EscapeState {
+  FnSymbol*                   fn;
+
+  // The block that allocates the object, NULL when analyzing a formal
+  BlockStmt*                  scope;
+
+  int                         depth;
+
+  std::map<Symbol*, CallExpr*> defs;
+  std::vector<Symbol*>        worklist;
+
+  // 'delete' and owned auto-destroy calls that free the object
+  std::vector<CallExpr*>      frees;
+
+  bool                        returned;
+  bool                        escaped;
+};
+
+static std::map<std::pair<FnSymbol*, Symbol*>, EscapeKind> formalEscapes;
+
+static EscapeKind formalEscape(FnSymbol* fn, ArgSymbol* formal, int depth);
+
+// dtOwned itself is gone once the generic types are pruned, and the
+// instantiations have been renamed to e.g. 'owned C'
+static bool isOwnedType(Type* type) {
+  Type* vt = type->getValType();
+
+  return isManagedPtrType(vt) &&
+         (startsWith(vt->symbol->name, "_owned(") ||
+          startsWith(vt->symbol->name, "owned "));
+}
+
+static bool isHeapAlloc(CallExpr* call) {
+  FnSymbol* fn = call->resolvedFunction();
+
+  return fn != NULL && strcmp(fn->name, "chpl_here_alloc") == 0;
+}
+
+// Add 'sym', defined by 'def', to the aliases of the object
+static void track(EscapeState& state, Symbol* sym, CallExpr* def) {
+  if (state.defs.count(sym) > 0) {
+    if (state.defs[sym] != def)
+      state.escaped = true;
+
+    return;
+  }
+
+  bool local = isVarSymbol(sym) && sym->defPoint->parentSymbol == state.fn;
+
+  if (local == false ||
+      (state.scope != NULL && state.scope->contains(sym->defPoint) == false)) {
+    state.escaped = true;
+    return;
+  }
+
+  state.defs[sym] = def;
+  state.worklist.push_back(sym);
+}
+
+// Track the variable that 'expr' is moved into
+static void trackResult(EscapeState& state, Expr* expr) {
+  CallExpr* move = toCallExpr(expr->parentExpr);
+
+  if (move != NULL && move->isPrimitive(PRIM_MOVE) && move->get(2) == expr) {
+    track(state, toSymExpr(move->get(1))->symbol(), move);
+  } else {
+    state.escaped = true;
+  }
+}
+
+static void checkCall(EscapeState& state, SymExpr* se, CallExpr* call) {
+  FnSymbol* fn    = call->resolvedFunction();
+  Symbol*   sym   = se->symbol();
+  bool      owned = isOwnedType(sym->type);
+
+  // Calls that free or manage the object in the allocating function
+  if (state.scope != NULL) {
+    if (strcmp(fn->name, "chpl__delete") == 0 && call->numActuals() == 1 &&
+        owned == false) {
+      state.frees.push_back(call);
+      return;
+    }
+
+    if (fn->hasFlag(FLAG_AUTO_DESTROY_FN) && owned) {
+      state.frees.push_back(call);
+      return;
+    }
+
+    if (fn->isInitializer() && isOwnedType(fn->_this->type) &&
+        call->numActuals() == 2 && call->get(2) == se && owned == false) {
+      track(state, toSymExpr(call->get(1))->symbol(), call);
+      return;
+    }
+
+    if (fn->name == astrBorrow && fn->isMethod() &&
+        call->numActuals() == 1 && owned) {
+      trackResult(state, call);
+      return;
+    }
+  }
+
+  if (owned ||
+      fn->hasFlag(FLAG_EXTERN) ||
+      isTaskFun(fn) ||
+      fn->isIterator()) {
+    state.escaped = true;
+    return;
+  }
+
+  ArgSymbol* formal = actual_to_formal(se);
+
+  // A callee could make a pointer passed by ref refer to something else
+  if (formal->isRef() && sym->isRef() == false) {
+    state.escaped = true;
+    return;
+  }
+
+  switch (formalEscape(fn, formal, state.depth + 1)) {
+  case ESCAPE_NONE:
+    break;
+
+  case ESCAPE_RETURNED:
+    if (isCallExpr(call->parentExpr))
+      trackResult(state, call);
+    break;
+
+  case ESCAPE_ANY:
+    state.escaped = true;
+    break;
+  }
+}
+
+static void checkUse(EscapeState& state, SymExpr* se) {
+  Symbol*   sym  = se->symbol();
+  CallExpr* call = toCallExpr(se->parentExpr);
+
+  if (call == NULL) {
+    state.escaped = true;
+    return;
+  }
+
+  if (state.defs[sym] == call && se == call->get(1))
+    return;
+
+  if (call->isPrimitive(PRIM_MOVE) || call->isPrimitive(PRIM_ASSIGN)) {
+    Symbol* lhs = toSymExpr(call->get(1))->symbol();
+
+    if (se == call->get(1)) {
+      // Storing through a reference into the object is fine,
+      // changing what an alias refers to is not
+      if (call->isPrimitive(PRIM_MOVE) || sym->isRef() == false)
+        state.escaped = true;
+
+    } else if (sym->isRef() && lhs->isRef() == false) {
+      // Reads a field through the reference
+
+    } else if (lhs->isRef() != sym->isRef()) {
+      state.escaped = true;
+
+    } else {
+      track(state, lhs, call);
+    }
+
+  } else if (call->isPrimitive(PRIM_GET_MEMBER) ||
+             call->isPrimitive(PRIM_GET_SVEC_MEMBER)) {
+    if (se == call->get(1))
+      trackResult(state, call);
+    else
+      state.escaped = true;
+
+  } else if (call->isPrimitive(PRIM_GET_MEMBER_VALUE) ||
+             call->isPrimitive(PRIM_GET_SVEC_MEMBER_VALUE) ||
+             call->isPrimitive(PRIM_SET_MEMBER) ||
+             call->isPrimitive(PRIM_SET_SVEC_MEMBER)) {
+    if (se != call->get(1))
+      state.escaped = true;
+
+  } else if (call->isPrimitive(PRIM_CAST)) {
+    trackResult(state, call);
+
+  } else if (call->isPrimitive(PRIM_DEREF) ||
+             call->isPrimitive(PRIM_CHECK_NIL) ||
+             call->isPrimitive(PRIM_EQUAL) ||
+             call->isPrimitive(PRIM_NOTEQUAL) ||
+             call->isPrimitive(PRIM_GETCID) ||
+             call->isPrimitive(PRIM_TESTCID) ||
+             call->isPrimitive(PRIM_SETCID) ||
+             call->isPrimitive(PRIM_NOOP)) {
+    // Reads the object or its fields
+
+  } else if (isOpEqualPrim(call)) {
+    if (se != call->get(1) || sym->isRef() == false)
+      state.escaped = true;
+
+  } else if (call->isPrimitive(PRIM_RETURN)) {
+    if (state.scope == NULL)
+      state.returned = true;
+    else
+      state.escaped = true;
+
+  } else if (call->resolvedFunction() != NULL) {
+    checkCall(state, se, call);
+
+  } else {
+    state.escaped = true;
+  }
+}
+
+static void analyze(EscapeState& state) {
+  while (state.worklist.size() > 0 && state.escaped == false) {
+    Symbol* sym = state.worklist.back();
+
+    state.worklist.pop_back();
+
+    for_SymbolSymExprs(se, sym) {
+      checkUse(state, se);
+
+      if (state.escaped)
+        break;
+    }
+  }
+}
+
+static EscapeKind formalEscape(FnSymbol* fn, ArgSymbol* formal, int depth) {
+  std::pair<FnSymbol*, Symbol*> key(fn, formal);
+  std::map<std::pair<FnSymbol*, Symbol*>, EscapeKind>::iterator it =
+    formalEscapes.find(key);
+
+  if (it != formalEscapes.end())
+    return it->second;
+
+  if (depth > kMaxCallDepth)
+    return ESCAPE_ANY;
+
+  // Recursive calls see the conservative answer
+  formalEscapes[key] = ESCAPE_ANY;
+
+  EscapeState state;
+
+  state.fn       = fn;
+  state.scope    = NULL;
+  state.depth    = depth;
+  state.returned = false;
+  state.escaped  = false;
+
+  state.defs[formal] = NULL;
+  state.worklist.push_back(formal);
+
+  analyze(state);
+
+  EscapeKind retval = ESCAPE_NONE;
+
+  if (state.escaped)
+    retval = ESCAPE_ANY;
+  else if (state.returned)
+    retval = ESCAPE_RETURNED;
+
+  formalEscapes[key] = retval;
+
+  return retval;
+}
+
+// A copy of the _new wrapper 'fn' that takes its memory as a final formal
+static FnSymbol* stackNewWrapper(FnSymbol* fn, AggregateType* at) {
+  static std::map<FnSymbol*, FnSymbol*> wrappers;
+
+  if (wrappers.count(fn) > 0)
+    return wrappers[fn];
+
+  SET_LINENO(fn);
+
+  FnSymbol*  retval = fn->copy();
+  ArgSymbol* mem    = new ArgSymbol(INTENT_CONST_IN, "chpl_mem", at);
+  std::vector<CallExpr*> calls;
+
+  collectCallExprs(retval, calls);
+
+  CallExpr* alloc = NULL;
+
+  for_vector(CallExpr, call, calls) {
+    if (isHeapAlloc(call)) {
+      if (alloc != NULL) {
+        alloc = NULL;
+        break;
+      }
+
+      alloc = call;
+    }
+  }
+
+  if (alloc == NULL) {
+    wrappers[fn] = NULL;
+    return NULL;
+  }
+
+  retval->insertFormalAtTail(mem);
+  alloc->replace(new CallExpr(PRIM_CAST, dtCVoidPtr->symbol, mem));
+
+  fn->defPoint->insertAfter(new DefExpr(retval));
+
+  wrappers[fn] = retval;
+
+  return retval;
+}
+
+static bool stackAllocate(FnSymbol* fn, CallExpr* move) {
+  CallExpr*      newCall = toCallExpr(move->get(2));
+  Symbol*        obj     = toSymExpr(move->get(1))->symbol();
+  AggregateType* at      = toAggregateType(canonicalClassType(obj->type));
+  BlockStmt*     scope   = toBlockStmt(move->parentExpr);
+
+  if (at == NULL || isClass(at) == false || scope == NULL)
+    return false;
+
+  EscapeState state;
+
+  state.fn       = fn;
+  state.scope    = scope;
+  state.depth    = 0;
+  state.returned = false;
+  state.escaped  = false;
+
+  track(state, obj, move);
+  analyze(state);
+
+  if (state.escaped)
+    return false;
+
+  FnSymbol* wrapper = stackNewWrapper(newCall->resolvedFunction(), at);
+
+  if (wrapper == NULL)
+    return false;
+
+  SET_LINENO(move);
+
+  VarSymbol* mem = newTemp("stack_mem", at);
+
+  move->insertBefore(new DefExpr(mem));
+  move->insertBefore(new CallExpr(PRIM_MOVE,
+                                  mem,
+                                  new CallExpr(PRIM_STACK_ALLOCATE_CLASS,
+                                               at->symbol)));
+
+  newCall->baseExpr->replace(new SymExpr(wrapper));
+  newCall->insertAtTail(new SymExpr(mem));
+
+  // The frees become plain deinit calls
+  for_vector(CallExpr, free, state.frees) {
+    SET_LINENO(free);
+
+    if (at->hasDestructor())
+      free->insertBefore(new CallExpr(at->getDestructor(), obj));
+
+    free->remove();
+  }
+
+  if (fReportStackAllocatedClasses &&
+      (developer || printsUserLocation(move))) {
+    USR_PRINT(move, "instance of '%s' is allocated on the stack",
+              at->symbol->name);
+  }
+
+  return true;
+}
+
+void stackAllocateClasses() {
+  if (fNoStackAllocateClasses)
+    return;
+
+  std::vector<CallExpr*> moves;
+
+  forv_Vec(CallExpr, call, gCallExprs) {
+    if (call->inTree() && call->isPrimitive(PRIM_MOVE)) {
+      if (CallExpr* rhs = toCallExpr(call->get(2))) {
+        FnSymbol* fn = rhs->resolvedFunction();
+
+        if (fn != NULL && fn->hasFlag(FLAG_NEW_WRAPPER))
+          moves.push_back(call);
+      }
+    }
+  }
+
+  for_vector(CallExpr, move, moves) {
+    stackAllocate(move->getFunction(), move);
+  }
+
+  formalEscapes.clear();
+}
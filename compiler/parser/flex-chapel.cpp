@@ -3804,9 +3804,12 @@ static int processSingleLineComment(yyscan_t scanner) {
   newString();
   countCommentLine();
 
-  // Read until the end of the line
+  // Read until the end of the line.  The parser discards these comments,
+  // so only keep the text when --print-tokens will echo it.
   while ((c = getNextYYChar(scanner)) != '\n' && c != 0) {
-    addChar(c);
+    if (printTokens) {
+      addChar(c);
+    }
   }
 
   countSingleLineComment(stringBuffer.c_str());
@@ -3815,7 +3818,7 @@ static int processSingleLineComment(yyscan_t scanner) {
     processNewline(scanner);
   }
 
-  yyLval->pch = astr(stringBuffer);
+  yyLval->pch = NULL;
 
   return YYLEX_SINGLE_LINE_COMMENT;
 }
@@ -3844,6 +3847,9 @@ static int processBlockComment(yyscan_t scanner) {
   int         depth        = 1;
   std::string wholeComment = "";
 
+  // The text is only used by chpldoc and --print-tokens
+  bool        keepText     = fDocs || printTokens;
+
   newString();
   countCommentLine();
 
@@ -3873,7 +3879,9 @@ static int processBlockComment(yyscan_t scanner) {
         }
       }
 
-      addChar(c);
+      if (keepText) {
+        addChar(c);
+      }
     }
 
     if (len != 0 && c == fDocsCommentLabel[len - d])
@@ -3913,7 +3921,7 @@ static int processBlockComment(yyscan_t scanner) {
     stringBuffer.resize(stringBuffer.size()-2);
 
   // back up further if the user has specified a special form of commenting
-  if (len > 2 && labelIndex == len)
+  if (keepText && len > 2 && labelIndex == len)
     stringBuffer.resize(stringBuffer.size() - (len - 2));
 
   // Saves the comment grabbed to the comment field of the location struct,
@@ -169,9 +169,10 @@
 //   Given a statement like "on expr do", based on chapel semantics there are
 //   a couple of optimizations we could perform:
 //     - If 'expr' is narrow/local, then the body of the on-statement will
-//       execute on the current locale. This means that we can avoid
-//       allocating the bundled args and avoid calling into the runtime.
-//       This may be beneficial for atomic operations.
+//       execute on the current locale. We already use this to keep the
+//       bundle and the body narrow (see deferOnStatements), but we could
+//       also avoid allocating the bundled args and avoid calling into the
+//       runtime. This may be beneficial for atomic operations.
 //
 //     - Under certain circumstances, 'expr' can be local within the body
 //       of the on-statement.
@@ -195,6 +196,7 @@
 #include "view.h"
 #include "wellknown.h"
 
+#include <algorithm>
 #include <map>
 #include <queue>
 #include <set>
@@ -254,6 +256,12 @@ static std::set<Symbol*> fieldsToMakeWide;
 // A map from a symbol to the BaseASTs that caused it to be wide
 static std::map<Symbol*, std::set<BaseAST*> > causes;
 
+// On-statements whose target is narrow at every call site, mapped to those
+// targets. A narrow target lives on the current locale, so such an
+// on-statement executes locally and its bundle can stay narrow unless one
+// of the targets is later widened. See activateDeferredOns().
+static std::map<FnSymbol*, std::vector<Symbol*> > deferredOns;
+
 // Various mini-passes to manipulate the AST into something functional
 static void convertNilToObject();
 static void buildWideClasses();
@@ -692,6 +700,70 @@ static FnSymbol* usedInOn(Symbol* sym) {
 }
 
 
+//
+// Returns the symbol an on-statement's locale is computed from when the
+// statement is of the form 'on obj', or NULL if the target is a locale or
+// is otherwise unknown.
+//
+static Symbol* onTargetSymbol(CallExpr* call) {
+  SymExpr* locale = toSymExpr(call->get(1));
+  if (locale == NULL) return NULL;
+
+  Vec<SymExpr*>* defs = defMap.get(locale->symbol());
+  if (defs == NULL || defs->n != 1) return NULL;
+
+  CallExpr* move = toCallExpr(defs->v[0]->parentExpr);
+  if (move == NULL || !move->isPrimitive(PRIM_MOVE)) return NULL;
+
+  CallExpr* rhs = toCallExpr(move->get(2));
+  if (rhs == NULL || !rhs->isPrimitive(PRIM_WIDE_GET_LOCALE)) return NULL;
+
+  SymExpr* target = toSymExpr(rhs->get(1));
+  if (target == NULL || !typeCanBeWide(target->symbol())) return NULL;
+
+  return target->symbol();
+}
+
+//
+// Optimistically assume that on-statements targeting an object run on the
+// current locale. Doing so keeps the bundle, the body, and everything the
+// body calls narrow until the target is proven to be wide.
+//
+static void deferOnStatements() {
+  forv_Vec(FnSymbol, fn, gFnSymbols) {
+    if (!fn->hasFlag(FLAG_ON_BLOCK) || fn->hasFlag(FLAG_LOCAL_ON)) continue;
+    if (fn->calledBy == NULL || fn->calledBy->n == 0) continue;
+
+    std::vector<Symbol*> targets;
+    forv_Vec(CallExpr, call, *fn->calledBy) {
+      if (!isAlive(call)) continue;
+
+      Symbol* target = onTargetSymbol(call);
+      if (target == NULL) {
+        targets.clear();
+        break;
+      }
+      targets.push_back(target);
+    }
+
+    if (targets.size() > 0) {
+      deferredOns[fn] = targets;
+    }
+  }
+}
+
+static void markDownstreamFromOn(FnSymbol* fn) {
+  forv_Vec(CallExpr, call, *fn->calledBy) {
+    if (!isAlive(call)) continue;
+
+    std::set<FnSymbol*> downstream;
+    collectUsedFnSymbols(call, downstream);
+    for_set(FnSymbol, on, downstream) {
+      downstreamFromOn[on] = true;
+    }
+  }
+}
+
 //
 // End of utility functions
 //
@@ -868,33 +940,32 @@ static void widenSubAggregateTypes(BaseAST* cause, Type* parent) {
 
 
 //
-// Widen variables that we don't know how to keep narrow.
+// Everything passed into an on-statement that may run remotely is wide.
 //
-static void addKnownWides() {
-  forv_Vec(FnSymbol, fn, gFnSymbols) {
-    if (fn->hasFlag(FLAG_ON_BLOCK) && !fn->hasFlag(FLAG_LOCAL_ON)) {
-      // Get the arg bundle type for an on-stmt. Testing against a name like
-      // "_class_localson_fn" is NOT enough, because sometimes the name is
-      // a bit more complicated. Recursive iterators may introduce this.
-      ArgSymbol* bundle_class = toArgSymbol(toDefExpr(fn->formals.tail)->sym);
-      AggregateType* ag = toAggregateType(bundle_class->type);
+static void widenOnBundle(FnSymbol* fn) {
+  // Get the arg bundle type for an on-stmt. Testing against a name like
+  // "_class_localson_fn" is NOT enough, because sometimes the name is
+  // a bit more complicated. Recursive iterators may introduce this.
+  ArgSymbol* bundle_class = toArgSymbol(toDefExpr(fn->formals.tail)->sym);
+  AggregateType* ag = toAggregateType(bundle_class->type);
 
-      for_fields(fi, ag) {
-        if (isRecord(fi->type) &&
-            !canWidenRecord(fi) &&
-            !fi->isRefOrWideRef()) {
-          // Record types won't be widened which means that their fields will
-          // lose all locality information inside the on-stmt. This means that
-          // such fields need to be wide. This may have to be done recursively
-          // if such a field is a record itself.
-          widenSubAggregateTypes(fn, fi->type);
-        } else {
-          DEBUG_PRINTF("Field %s (%d) is in an on bundle, must be wide\n", fi->cname, fi->id);
-          setWide(fn, fi);
-        }
-      }
+  for_fields(fi, ag) {
+    if (isRecord(fi->type) &&
+        !canWidenRecord(fi) &&
+        !fi->isRefOrWideRef()) {
+      // Record types won't be widened which means that their fields will
+      // lose all locality information inside the on-stmt. This means that
+      // such fields need to be wide. This may have to be done recursively
+      // if such a field is a record itself.
+      widenSubAggregateTypes(fn, fi->type);
+    } else {
+      DEBUG_PRINTF("Field %s (%d) is in an on bundle, must be wide\n", fi->cname, fi->id);
+      setWide(fn, fi);
     }
   }
+}
+
+static void widenModuleVarsUsedInOn() {
   forv_Vec(VarSymbol, var, gVarSymbols) {
     //if (!typeCanBeWide(var)) continue;
     Symbol* defParent = var->defPoint->parentSymbol;
@@ -915,6 +986,20 @@ static void addKnownWides() {
       }
     }
   }
+}
+
+//
+// Widen variables that we don't know how to keep narrow.
+//
+static void addKnownWides() {
+  forv_Vec(FnSymbol, fn, gFnSymbols) {
+    if (fn->hasFlag(FLAG_ON_BLOCK) && !fn->hasFlag(FLAG_LOCAL_ON) &&
+        deferredOns.count(fn) == 0) {
+      widenOnBundle(fn);
+    }
+  }
+
+  widenModuleVarsUsedInOn();
 
   // Widen the arguments of virtual methods
   forv_Vec(ArgSymbol, arg, gArgSymbols) {
@@ -2355,6 +2440,191 @@ static void fixRecordWrappedTypes() {
   }
 }
 
+//
+// Activate the deferred on-statements with a target that became wide.
+// Returns true if anything was activated, in which case propagation has to
+// continue.
+//
+static bool activateDeferredOns() {
+  std::vector<FnSymbol*> activated;
+
+  for (std::map<FnSymbol*, std::vector<Symbol*> >::iterator it = deferredOns.begin();
+       it != deferredOns.end(); ++it) {
+    for_vector(Symbol, target, it->second) {
+      if (hasSomeWideness(target)) {
+        activated.push_back(it->first);
+        break;
+      }
+    }
+  }
+
+  for_vector(FnSymbol, fn, activated) {
+    DEBUG_PRINTF("On-statement %s (%d) may be remote\n", fn->cname, fn->id);
+    deferredOns.erase(fn);
+    widenOnBundle(fn);
+    markDownstreamFromOn(fn);
+  }
+
+  if (activated.size() > 0) {
+    widenModuleVarsUsedInOn();
+  }
+
+  return activated.size() > 0;
+}
+
+//
+// The user variables and formals listed by --report-wide-references.
+//
+static bool isReportedSymbol(Symbol* sym) {
+  return (isVarSymbol(sym) || isArgSymbol(sym)) &&
+         !sym->hasFlag(FLAG_TEMP) &&
+         sym->name[0] != '_' &&
+         sym->defPoint != NULL &&
+         !isTypeSymbol(sym->defPoint->parentSymbol) &&
+         !sym->defPoint->parentSymbol->hasFlag(FLAG_COMPILER_GENERATED) &&
+         sym->getModule()->modTag == MOD_USER;
+}
+
+static bool compareIds(BaseAST* a, BaseAST* b) {
+  return a->id < b->id;
+}
+
+static bool compareLines(Symbol* a, Symbol* b) {
+  if (a->linenum() != b->linenum()) return a->linenum() < b->linenum();
+  return a->id < b->id;
+}
+
+//
+// Follow the causes of a wide symbol back to whatever first made something
+// wide. Returns that root and sets 'rooted' to the symbol it widened. 'via'
+// is set to the user-visible symbol nearest to the root along the way.
+//
+static BaseAST* findWideRoot(Symbol* sym, Symbol*& rooted, Symbol*& via) {
+  std::map<Symbol*, Symbol*> from;
+  std::queue<Symbol*> work;
+  BaseAST* root = NULL;
+
+  from[sym] = NULL;
+  work.push(sym);
+  rooted = sym;
+
+  while (!work.empty() && root == NULL) {
+    Symbol* cur = work.front();
+    work.pop();
+
+    std::vector<BaseAST*> parents(causes[cur].begin(), causes[cur].end());
+    std::sort(parents.begin(), parents.end(), compareIds);
+
+    if (parents.size() == 0) {
+      root = cur;
+      rooted = cur;
+    }
+
+    for_vector(BaseAST, parent, parents) {
+      Symbol* psym = toSymbol(parent);
+      if (SymExpr* se = toSymExpr(parent)) psym = se->symbol();
+
+      if (psym == NULL || isFnSymbol(psym) || isModuleSymbol(psym)) {
+        root = parent;
+        rooted = cur;
+        break;
+      } else if (from.count(psym) == 0) {
+        from[psym] = cur;
+        work.push(psym);
+      }
+    }
+  }
+
+  via = NULL;
+  for (Symbol* step = rooted; step != NULL && step != sym; step = from[step]) {
+    if (isReportedSymbol(step)) {
+      via = step;
+      break;
+    }
+  }
+
+  return root;
+}
+
+//
+// Describe why 'root' made 'sym' wide, as a predicate for "it ...".
+//
+static const char* describeWideRoot(BaseAST* root, Symbol* sym) {
+  if (ModuleSymbol* mod = toModuleSymbol(root)) {
+    return astr("is a module-scope variable of ", mod->name,
+                " that other locales may access");
+  } else if (FnSymbol* fn = toFnSymbol(root)) {
+    if (fn->hasFlag(FLAG_ON_BLOCK)) {
+      return astr("is passed into the on-statement at line ",
+                  istr(fn->linenum()));
+    } else if (isModuleSymbol(sym->defPoint->parentSymbol)) {
+      return "is a module-scope variable used within an on-statement";
+    } else if (fn->hasFlag(FLAG_VIRTUAL) && sym == fn->getReturnSymbol()) {
+      return "is returned from a dynamically dispatched method";
+    } else if (isArgSymbol(sym)) {
+      return "is a formal of a function that is called indirectly";
+    }
+  } else if (CallExpr* call = toCallExpr(root)) {
+    if (call->isPrimitive(PRIM_VIRTUAL_METHOD_CALL)) {
+      return "is passed to a dynamically dispatched method";
+    } else if (call->primitive) {
+      return astr("is used by the '", call->primitive->name, "' primitive");
+    }
+  }
+
+  return "may refer to remote data";
+}
+
+//
+// --report-wide-references: list the user variables that are still wide,
+// and the reason each of them had to be widened.
+//
+static void reportWideReferences() {
+  std::vector<Symbol*> wides;
+
+  forv_Vec(VarSymbol, var, gVarSymbols) {
+    if (isAlive(var) && isReportedSymbol(var) && hasSomeWideness(var)) {
+      wides.push_back(var);
+    }
+  }
+  forv_Vec(ArgSymbol, arg, gArgSymbols) {
+    if (isAlive(arg) && isReportedSymbol(arg) && hasSomeWideness(arg)) {
+      wides.push_back(arg);
+    }
+  }
+
+  std::sort(wides.begin(), wides.end(), compareLines);
+
+  for_vector(Symbol, sym, wides) {
+    Symbol* rooted = NULL;
+    Symbol* via = NULL;
+    BaseAST* root = findWideRoot(sym, rooted, via);
+    const char* reason = describeWideRoot(root, rooted);
+
+    if (via != NULL) {
+      USR_PRINT(sym, "'%s' is wide because it is derived from '%s', which %s",
+                sym->name, via->name, reason);
+    } else {
+      USR_PRINT(sym, "'%s' is wide because it %s", sym->name, reason);
+    }
+  }
+
+  std::vector<Symbol*> localOns;
+  for (std::map<FnSymbol*, std::vector<Symbol*> >::iterator it = deferredOns.begin();
+       it != deferredOns.end(); ++it) {
+    if (it->first->getModule()->modTag == MOD_USER) {
+      localOns.push_back(it->first);
+    }
+  }
+
+  std::sort(localOns.begin(), localOns.end(), compareLines);
+
+  for_vector(Symbol, fn, localOns) {
+    USR_PRINT(fn, "on-statement target is local, "
+              "so what the on-statement uses is kept narrow");
+  }
+}
+
 //
 // Widen variables that may be remote.
 //
@@ -2454,12 +2724,17 @@ insertWideReferences(void) {
   buildDefUseMaps(defMap, useMap);
   buildTupleDefsUses();
 
+  if (!fNoOptimizeOnClauses) {
+    deferOnStatements();
+  }
+
   //
   // Track functions downstream in the call-chain from a wrapon_fn
   //
   forv_Vec(CallExpr, call, gCallExprs) {
     if (FnSymbol* fn = call->resolvedFunction()) {
-      if (fn->hasFlag(FLAG_ON_BLOCK) && !fn->hasFlag(FLAG_LOCAL_ON)) { // wrapon_fn
+      if (fn->hasFlag(FLAG_ON_BLOCK) && !fn->hasFlag(FLAG_LOCAL_ON) && // wrapon_fn
+          deferredOns.count(fn) == 0) {
         std::set<FnSymbol*> downstream;
         collectUsedFnSymbols(call, downstream);
         for_set(FnSymbol, on, downstream) {
@@ -2482,18 +2757,25 @@ insertWideReferences(void) {
   }
 
   //
-  // Propagate wide pointers through the AST.
+  // Propagate wide pointers through the AST. Deferred on-statements whose
+  // targets were widened may now run remotely, which widens more.
   //
-  while (!queueEmpty()) {
-    Symbol* sym = queuePop();
-    if (isField(sym)) {
-      propagateField(sym);
-    } else {
-      propagateVar(sym);
+  do {
+    while (!queueEmpty()) {
+      Symbol* sym = queuePop();
+      if (isField(sym)) {
+        propagateField(sym);
+      } else {
+        propagateVar(sym);
+      }
     }
-  }
+  } while (activateDeferredOns());
   debugTimer.stop();
 
+  if (fReportWideReferences) {
+    reportWideReferences();
+  }
+
   //
   // For codegen purposes, it's easier to represent some fields as a wide type.
   // fixAST() will insert local temps in the case that a field is always
@@ -35,6 +35,7 @@
 #include "initializerRules.h"
 #include "library.h"
 #include "LoopExpr.h"
+#include "optimizations.h"
 #include "scopeResolve.h"
 #include "splitInit.h"
 #include "stlUtil.h"
@@ -128,6 +129,8 @@ void normalize() {
 
   checkReduceAssign();
 
+  autoAggregateForalls();
+
   forv_Vec(AggregateType, at, gAggregateTypes) {
     if (isClassWithInitializers(at)  == true ||
         isRecordOrUnionWithInitializers(at) == true) {
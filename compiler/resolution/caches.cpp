@@ -21,9 +21,12 @@
 #include "caches.h"
 
 #include "astutil.h"
+#include "driver.h"
 #include "stmt.h"
 #include "stringutil.h"
 
+#include <algorithm>
+
 
 /************************************* | **************************************
 *                                                                             *
@@ -31,13 +34,108 @@
 *                                                                             *
 ************************************** | *************************************/
 
-SymbolMapCache genericsCache;
-SymbolMapCache promotionsCache;
+SymbolMapCache genericsCache("genericsCache");
+SymbolMapCache promotionsCache("promotionsCache");
+
+static const int kInitialBuckets = 64;
 
 static bool isCacheEntryMatch(SymbolMap* s1, SymbolMap* s2);
 
-SymbolMapCacheEntry::SymbolMapCacheEntry(FnSymbol* ifn, SymbolMap* imap) :
-  fn(ifn), map(*imap) { }
+SymbolMapCacheEntry::SymbolMapCacheEntry(FnSymbol*    ioldFn,
+                                         FnSymbol*    ifn,
+                                         SymbolMap*   imap,
+                                         unsigned int ihash) :
+  oldFn(ioldFn), fn(ifn), map(*imap), hash(ihash), next(NULL) { }
+
+SymbolMapCache::SymbolMapCache(const char* iname) :
+  name(iname), nEntries(0), nLookups(0), nProbes(0), maxProbe(0) { }
+
+
+static unsigned int hashPointer(void* p) {
+  uintptr_t x = (uintptr_t) p;
+
+  x ^= x >> 33;
+  x *= 0xff51afd7ed558ccdULL;
+  x ^= x >> 33;
+
+  return (unsigned int) x;
+}
+
+//
+// Combine the pairs commutatively so that the hash does not depend on
+// where they landed in the map.  Pairs with a NULL value are skipped
+// because isCacheEntryMatch() treats them as absent.
+//
+static unsigned int hashSymbolMap(FnSymbol* oldFn, SymbolMap* map) {
+  unsigned int retval = hashPointer(oldFn);
+
+  form_Map(SymbolMapElem, e, *map) {
+    if (e->value != NULL) {
+      retval += hashPointer(e->key) * 31 + hashPointer(e->value);
+    }
+  }
+
+  return retval;
+}
+
+static SymbolMapCacheEntry** getBucket(SymbolMapCache& cache,
+                                       unsigned int    hash) {
+  return &cache.buckets.v[hash % cache.buckets.n];
+}
+
+static void growCache(SymbolMapCache& cache) {
+  Vec<SymbolMapCacheEntry*> old;
+
+  old.move(cache.buckets);
+
+  cache.buckets.fill(old.n == 0 ? kInitialBuckets : 2 * old.n);
+
+  // Re-link each chain in order so that earlier entries stay first
+  forv_Vec(SymbolMapCacheEntry, entry, old) {
+    while (entry != NULL) {
+      SymbolMapCacheEntry*  next = entry->next;
+      SymbolMapCacheEntry** tail = getBucket(cache, entry->hash);
+
+      while (*tail != NULL)
+        tail = &(*tail)->next;
+
+      entry->next = NULL;
+      *tail       = entry;
+
+      entry = next;
+    }
+  }
+}
+
+static SymbolMapCacheEntry* findCacheEntry(SymbolMapCache& cache,
+                                           FnSymbol*       oldFn,
+                                           SymbolMap*      map) {
+  SymbolMapCacheEntry* retval = NULL;
+
+  if (cache.nEntries > 0) {
+    unsigned int hash   = hashSymbolMap(oldFn, map);
+    int          probes = 0;
+
+    for (SymbolMapCacheEntry* entry = *getBucket(cache, hash);
+         entry != NULL && retval == NULL;
+         entry = entry->next) {
+      probes++;
+
+      if (entry->hash  == hash  &&
+          entry->oldFn == oldFn &&
+          isCacheEntryMatch(map, &entry->map)) {
+        retval = entry;
+      }
+    }
+
+    cache.nProbes  += probes;
+    cache.maxProbe  = std::max(cache.maxProbe, probes);
+  }
+
+  cache.nLookups++;
+
+  return retval;
+}
 
 
 void
@@ -45,29 +143,29 @@ addCache(SymbolMapCache& cache,
          FnSymbol*       oldFn,
          FnSymbol*       fn,
          SymbolMap*      map) {
-  Vec<SymbolMapCacheEntry*>* entries = cache.get(oldFn);
-  SymbolMapCacheEntry*       entry   = new SymbolMapCacheEntry(fn, map);
+  unsigned int          hash  = hashSymbolMap(oldFn, map);
+  SymbolMapCacheEntry*  entry = new SymbolMapCacheEntry(oldFn, fn, map, hash);
+  SymbolMapCacheEntry** tail  = NULL;
 
-  if (entries) {
-    entries->add(entry);
+  if (cache.nEntries >= cache.buckets.n)
+    growCache(cache);
 
-  } else {
-    entries = new Vec<SymbolMapCacheEntry*>();
-    entries->add(entry);
-    cache.put(oldFn, entries);
-  }
+  tail = getBucket(cache, hash);
+
+  while (*tail != NULL)
+    tail = &(*tail)->next;
+
+  *tail = entry;
+
+  cache.nEntries++;
 }
 
 
 FnSymbol*
 checkCache(SymbolMapCache& cache, FnSymbol* oldFn, SymbolMap* map) {
-  if (Vec<SymbolMapCacheEntry*>* entries = cache.get(oldFn)) {
-    forv_Vec(SymbolMapCacheEntry, entry, *entries) {
-      if (isCacheEntryMatch(map, &entry->map))
-        return entry->fn;
-    }
-  }
-  return NULL;
+  SymbolMapCacheEntry* entry = findCacheEntry(cache, oldFn, map);
+
+  return entry != NULL ? entry->fn : NULL;
 }
 
 
@@ -76,13 +174,9 @@ replaceCache(SymbolMapCache& cache,
              FnSymbol*       oldFn,
              FnSymbol*       fn,
              SymbolMap*      map) {
-  if (Vec<SymbolMapCacheEntry*>* entries = cache.get(oldFn)) {
-    forv_Vec(SymbolMapCacheEntry, entry, *entries) {
-      if (isCacheEntryMatch(map, &entry->map)) {
-        entry->fn = fn;
-        return;
-      }
-    }
+  if (SymbolMapCacheEntry* entry = findCacheEntry(cache, oldFn, map)) {
+    entry->fn = fn;
+    return;
   }
 
   INT_FATAL(oldFn, "unable to replace cache entry; entry does not exist");
@@ -91,13 +185,30 @@ replaceCache(SymbolMapCache& cache,
 
 void
 freeCache(SymbolMapCache& cache) {
-  form_Map(SymbolMapCacheElem, elem, cache) {
-    forv_Vec(SymbolMapCacheEntry, entry, *elem->value) {
+  if (fPrintStatistics[0] != '\0' && cache.nLookups > 0) {
+    fprintf(stderr,
+            "%7d %s entries, %d lookups, %.2f average probe length, "
+            "%d maximum\n",
+            cache.nEntries, cache.name, cache.nLookups,
+            (double) cache.nProbes / cache.nLookups, cache.maxProbe);
+  }
+
+  forv_Vec(SymbolMapCacheEntry, entry, cache.buckets) {
+    while (entry != NULL) {
+      SymbolMapCacheEntry* next = entry->next;
+
       delete entry;
+
+      entry = next;
     }
-    delete elem->value;
   }
-  cache.clear();
+
+  cache.buckets.clear();
+
+  cache.nEntries = 0;
+  cache.nLookups = 0;
+  cache.nProbes  = 0;
+  cache.maxProbe = 0;
 }
 
 static bool isCacheEntryMatch(SymbolMap* s1, SymbolMap* s2) {
@@ -36,16 +36,36 @@
 //
 //   freeCache(cache): frees memory associated with cache
 //
+//   The entries are kept in a chained hash table indexed by old_fn and
+//   an order-independent hash of the map, so only entries whose maps
+//   hash alike are compared pair by pair.
+//
 class SymbolMapCacheEntry {
 public:
-  SymbolMapCacheEntry(FnSymbol* ifn, SymbolMap* imap);
-
-  FnSymbol* fn;
-  SymbolMap map;
+  SymbolMapCacheEntry(FnSymbol* ioldFn, FnSymbol* ifn, SymbolMap* imap,
+                      unsigned int ihash);
+
+  FnSymbol*            oldFn;
+  FnSymbol*            fn;
+  SymbolMap            map;
+  unsigned int         hash;
+  SymbolMapCacheEntry* next;
 };
 
-typedef Map<FnSymbol*,     Vec<SymbolMapCacheEntry*>*> SymbolMapCache;
-typedef MapElem<FnSymbol*, Vec<SymbolMapCacheEntry*>*> SymbolMapCacheElem;
+class SymbolMapCache {
+public:
+                       SymbolMapCache(const char* iname);
+
+  const char*          name;
+
+  Vec<SymbolMapCacheEntry*> buckets;
+  int                  nEntries;
+
+  // Reported under --print-statistics
+  int                  nLookups;
+  int                  nProbes;
+  int                  maxProbe;
+};
 
 
 void      addCache(SymbolMapCache& cache,
@@ -73,6 +93,12 @@ void      freeCache(SymbolMapCache& cache);
 // when instantiating constructors and building up the default
 // wrappers for constructors.
 //
+// They are also why function resolution has to stay single-threaded:
+// the first instantiation recorded here is the one every later call
+// uses, so resolving independent functions concurrently would make
+// the set of generated functions depend on thread timing, in addition
+// to racing on the AST id counter, the gVecs and the AST allocator.
+//
 
 extern SymbolMapCache genericsCache;
 extern SymbolMapCache promotionsCache;
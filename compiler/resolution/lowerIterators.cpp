@@ -253,6 +253,7 @@ static bool doesFnHaveVectorHazard(FnSymbol* fn,
     thisTypeSymbol = fn->_this->getValType()->symbol;
 
   CallExpr* reason = NULL;
+  const char* other = NULL;
   bool hazard = false;
   if (fn->hasFlag(FLAG_LLVM_READNONE) ||
       fn->hasFlag(FLAG_FN_SYNCHRONIZATION_FREE) ||
@@ -266,12 +267,14 @@ static bool doesFnHaveVectorHazard(FnSymbol* fn,
     // Who knows what extern functions do!
     // To allow an extern function, mark it with FLAG_FN_SYNCHRONIZATION_FREE.
     hazard = true;
+    other = "is an extern function";
   } else if (thisTypeSymbol != NULL &&
              (thisTypeSymbol->hasFlag(FLAG_ATOMIC_TYPE) ||
               thisTypeSymbol->hasFlag(FLAG_SYNC) ||
               thisTypeSymbol->hasFlag(FLAG_SINGLE))) {
     // methods on synchronization constructs do synchronization!
     hazard = true;
+    other = "is a method on a synchronization type";
   } else {
     // Check what the function body includes.
     VectorHazardVisitor v(fnHasVectorHazard);
@@ -299,6 +302,8 @@ static bool doesFnHaveVectorHazard(FnSymbol* fn,
       USR_PRINT(fn, "fn %s hazard -- calls synchronizing function %s", fn->name, calledFn->name);
     else if (reason && reason->isPrimitive(PRIM_VIRTUAL_METHOD_CALL))
       USR_PRINT(fn, "fn %s hazard -- calls virtual function", fn->name);
+    else if (other)
+      USR_PRINT(fn, "fn %s hazard -- %s", fn->name, other);
     else
       USR_PRINT(fn, "fn %s hazard -- other", fn->name);
   }
@@ -396,6 +401,7 @@ static void markVectorizableForallLoops()
     // away and/or inlined.
 
     // Does the loop use a reduction type that is not vectorizable yet?
+    ShadowVarSymbol* badReduce = NULL;
     for_shadow_vars (shadow, temp, forall) {
       if (shadow->isReduce()) {
         if (ShadowVarSymbol* op = shadow->ReduceOpForAccumState()) {
@@ -412,8 +418,11 @@ static void markVectorizableForallLoops()
             if (startsWith(opType->symbol->name, "SumReduceScanOp"))
               ok = true;
           }
-          if (ok == false)
+          if (ok == false) {
             hazard = true;
+            if (badReduce == NULL)
+              badReduce = shadow;
+          }
         }
       }
     }
@@ -437,6 +446,8 @@ static void markVectorizableForallLoops()
         USR_PRINT(forall, "Vectorization hazard -- calls synchronizing function %s", fn->name);
        else if (v.hazard && v.reason && v.reason->isPrimitive(PRIM_VIRTUAL_METHOD_CALL))
         USR_PRINT(forall, "Vectorization hazard -- calls virtual function");
+      else if (badReduce)
+        USR_PRINT(forall, "Vectorization hazard -- reduction into %s is not a + reduction over numbers", badReduce->name);
       else
         USR_PRINT(forall, "Vectorization hazard -- other");
     }
@@ -2936,6 +2947,9 @@ void lowerIterators() {
 
   cleanupLeaderIteratorCalls();
 
+  if (fReportAutoAggregation)
+    reportAutoAggregation();
+
   lowerForallStmtsInline();
 
   for_alive_in_Vec(FnSymbol, fn, gFnSymbols) {
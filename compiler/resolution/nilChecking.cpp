@@ -20,6 +20,7 @@
 
 #include "lifetime.h"
 
+#include "analysisManager.h"
 #include "AstVisitorTraverse.h"
 #include "bb.h"
 #include "bitVec.h"
@@ -1322,7 +1323,7 @@ static void findNilDereferencesInFn(FnSymbol* fn) {
     gdbShouldBreakHere();
   }
 
-  BasicBlock::buildBasicBlocks(fn);
+  getBasicBlocks(fn);
 
   // Stores variables we are considering
   std::vector<Symbol*> idxToSym;
@@ -44,6 +44,7 @@ static child type could end up calling something in the parent.
 
 #include "virtualDispatch.h"
 
+#include "astlocs.h"
 #include "astutil.h"
 #include "baseAST.h"
 #include "callInfo.h"
@@ -57,6 +58,7 @@ static child type could end up calling something in the parent.
 #include "stmt.h"
 #include "symbol.h"
 
+#include <map>
 #include <set>
 #include <vector>
 
@@ -1176,7 +1178,7 @@ static void checkMethodsOverride() {
 * specific method based on the static type of the receiver.  This phase       *
 * inspects every call to determine if 1 or more derived classes define an     *
 * override for the method.  These calls are generally be converted to be uses *
-* of PRIM_VIRTUAL_METHOD_CALL.  There are two exceptions:                     *
+* of PRIM_VIRTUAL_METHOD_CALL.  There are three exceptions:                   *
 *                                                                             *
 *    1) The receiver is "super".  This is intended to allow an overriding     *
 *       method to invoke the most specific method that is being overridden    *
@@ -1187,11 +1189,22 @@ static void checkMethodsOverride() {
 *       this.init(...) c.f. convenience initializers in Swift.  Note that     *
 *       super.init() is covered by exception 1.                               *
 *                                                                             *
+*    3) Every class the receiver can be an instance of selects the same       *
+*       method.  The call is bound directly to that method.                   *
+*                                                                             *
 ************************************** | *************************************/
 
 static bool wasSuperDot(CallExpr* call);
 
+static FnSymbol* devirtualizedTarget(CallExpr* call, FnSymbol* fn);
+
+static void      bindToTarget(CallExpr* call, FnSymbol* target, Expr* _this);
+
 void insertDynamicDispatchCalls() {
+  if (fNoDevirtualize == false) {
+    computeDispatchTypes();
+  }
+
   forv_Vec(CallExpr, call, gCallExprs) {
     if (call->inTree()) {
       if (FnSymbol* fn = call->resolvedFunction()) {
@@ -1201,6 +1214,21 @@ void insertDynamicDispatchCalls() {
             call->isNamed("init")      == false) {   // Not an initializer
           SET_LINENO(call);
 
+          if (FnSymbol* target = devirtualizedTarget(call, fn)) {
+            bindToTarget(call, target, call->get(2));
+
+            if (fReportDevirtualizedCalls == true &&
+                (developer == true || printsUserLocation(call) == true)) {
+              USR_PRINT(call,
+                        "virtual call to '%s' dispatches only to '%s.%s'",
+                        fn->name,
+                        target->_this->getValType()->symbol->name,
+                        target->name);
+            }
+
+            continue;
+          }
+
           // The variable <cid> must have the same size as the type
           // of chpl__class_id / chpl_cid_* to ensure the value is
           // transmitted correctly for a remote class.
@@ -1226,6 +1254,8 @@ void insertDynamicDispatchCalls() {
       }
     }
   }
+
+  clearDispatchTypes();
 }
 
 // Return true if this call was originally super.<method>()
@@ -1238,3 +1268,376 @@ static bool wasSuperDot(CallExpr* call) {
 
   return retval;
 }
+
+static FnSymbol* devirtualizedTarget(CallExpr* call, FnSymbol* fn) {
+  TargetMap targets;
+  FnSymbol* retval  = NULL;
+
+  if (fNoDevirtualize == false &&
+      virtualCallTargets(call, fn, call->get(2), targets) == true &&
+      targets.size() == 1) {
+    retval = targets.begin()->first;
+  }
+
+  return retval;
+}
+
+/************************************* | **************************************
+*                                                                             *
+* Class hierarchy analysis for virtual calls.                                 *
+*                                                                             *
+* An object's class id is set by PRIM_SETCID.  The one in a _new wrapper      *
+* (or any other function that is not an initializer) gives the object its    *
+* final class.  The one in an initializer gives 'this' the class of that      *
+* initializer while it runs, including when it is a parent class              *
+* initializer invoked through super.init(); the caller sets the class id      *
+* again once the parent initializer returns.                                  *
+*                                                                             *
+* So a receiver can only be an instance of an allocated class, unless the     *
+* call may run within an initializer, in which case it can be an instance     *
+* of any class whose id is set anywhere.                                      *
+*                                                                             *
+************************************** | *************************************/
+
+static std::set<AggregateType*> allocatedClasses;
+static std::set<AggregateType*> initializedClasses;
+static std::set<FnSymbol*>      fnsReachableFromInits;
+
+static AggregateType* receiverClassType(Expr* _this);
+
+static void           addReachableFn(FnSymbol*               fn,
+                                     std::vector<FnSymbol*>& worklist);
+
+void computeDispatchTypes() {
+  std::vector<FnSymbol*> worklist;
+
+  forv_Vec(CallExpr, call, gCallExprs) {
+    if (call->inTree() && call->isPrimitive(PRIM_SETCID)) {
+      FnSymbol* fn = call->getFunction();
+
+      if (fn->isResolved() == true) {
+        if (AggregateType* at = receiverClassType(call->get(1))) {
+          initializedClasses.insert(at);
+
+          if (fn->isInitializer() == false) {
+            allocatedClasses.insert(at);
+          }
+        }
+      }
+    }
+  }
+
+  forv_Vec(FnSymbol, fn, gFnSymbols) {
+    if (fn->inTree()                      == true &&
+        fn->isResolved()                  == true &&
+        fn->isInitializer()               == true &&
+        isClassLike(fn->_this->getValType()) == true) {
+      addReachableFn(fn, worklist);
+    }
+  }
+
+  while (worklist.size() > 0) {
+    FnSymbol*              fn = worklist.back();
+    std::vector<CallExpr*> calls;
+
+    worklist.pop_back();
+
+    collectCallExprs(fn->body, calls);
+
+    for_vector(CallExpr, call, calls) {
+      if (FnSymbol* calledFn = call->resolvedOrVirtualFunction()) {
+        addReachableFn(calledFn, worklist);
+
+        if (Vec<FnSymbol*>* children = virtualChildrenMap.get(calledFn)) {
+          forv_Vec(FnSymbol, childFn, *children) {
+            addReachableFn(childFn, worklist);
+          }
+        }
+      }
+    }
+  }
+}
+
+void clearDispatchTypes() {
+  allocatedClasses.clear();
+  initializedClasses.clear();
+  fnsReachableFromInits.clear();
+}
+
+static void addReachableFn(FnSymbol*               fn,
+                           std::vector<FnSymbol*>& worklist) {
+  if (fnsReachableFromInits.insert(fn).second == true) {
+    worklist.push_back(fn);
+  }
+}
+
+static AggregateType* receiverClassType(Expr* _this) {
+  AggregateType* retval = NULL;
+
+  if (_this->isRefOrWideRef() == false && isClassLike(_this->typeInfo())) {
+    if (AggregateType* at = toAggregateType(canonicalClassType(_this->typeInfo()))) {
+      if (at->isClass() == true && at->symbol->hasFlag(FLAG_EXTERN) == false) {
+        retval = at;
+      }
+    }
+  }
+
+  return retval;
+}
+
+// Returns true if 'target' can stand in for 'fn' at a call site
+// without changing the types of the actuals or of the result
+static bool isCompatibleTarget(FnSymbol* fn, FnSymbol* target) {
+  bool retval = target->retType == fn->retType &&
+                target->retTag  == fn->retTag  &&
+                target->numFormals() == fn->numFormals();
+
+  for (int i = 3; i <= fn->numFormals() && retval == true; i++) {
+    ArgSymbol* formal       = fn->getFormal(i);
+    ArgSymbol* targetFormal = target->getFormal(i);
+
+    retval = targetFormal->type   == formal->type &&
+             targetFormal->intent == formal->intent;
+  }
+
+  return retval;
+}
+
+//
+// Collect the methods a call to 'fn' with the receiver '_this' can
+// dispatch to, each with the classes that select it.  Returns false if
+// they cannot be determined, or if one of them cannot be called directly.
+// computeDispatchTypes() must have been called.
+//
+bool virtualCallTargets(CallExpr*  call,
+                        FnSymbol*  fn,
+                        Expr*      _this,
+                        TargetMap& targets) {
+  AggregateType*            at      = receiverClassType(_this);
+  std::set<AggregateType*>* classes = &allocatedClasses;
+  int                       index   = virtualMethodMap.get(fn);
+  std::vector<AggregateType*> subtypes;
+  std::set<AggregateType*>    visited;
+
+  if (at                                   == NULL  ||
+      fn->isIterator()                     == true  ||
+      fn->retType->symbol->hasFlag(FLAG_ITERATOR_RECORD) == true) {
+    return false;
+  }
+
+  if (fnsReachableFromInits.count(call->getFunction()) > 0) {
+    classes = &initializedClasses;
+  }
+
+  subtypes.push_back(at);
+  visited.insert(at);
+
+  while (subtypes.size() > 0) {
+    AggregateType* subtype = subtypes.back();
+
+    subtypes.pop_back();
+
+    if (classes->count(subtype) > 0) {
+      Vec<FnSymbol*>* fns = virtualMethodTable.get(subtype);
+
+      if (fns == NULL || index >= fns->n) {
+        return false;
+      }
+
+      FnSymbol* target = fns->v[index];
+
+      if (target->name != fn->name ||
+          isCompatibleTarget(fn, target) == false) {
+        return false;
+      }
+
+      targets[target].push_back(subtype);
+    }
+
+    forv_Vec(AggregateType, child, subtype->dispatchChildren) {
+      if (child != NULL && visited.insert(child).second == true) {
+        subtypes.push_back(child);
+      }
+    }
+  }
+
+  return true;
+}
+
+// Make 'call' a direct call to 'target'.  The receiver '_this' is cast to
+// the class of 'target' if that is more specific than its static type.
+static void bindToTarget(CallExpr* call, FnSymbol* target, Expr* _this) {
+  Type* thisType = target->_this->type;
+
+  if (receiverClassType(_this) != canonicalClassType(thisType)) {
+    Expr*      stmt   = call->getStmtExpr();
+    VarSymbol* tmp    = newTemp("_virtual_method_this_", thisType);
+    CallExpr*  cast   = new CallExpr(PRIM_CAST, thisType->symbol, _this->copy());
+
+    stmt->insertBefore(new DefExpr(tmp));
+    stmt->insertBefore(new CallExpr(PRIM_MOVE, tmp, cast));
+
+    _this->replace(new SymExpr(tmp));
+  }
+
+  call->baseExpr->replace(new SymExpr(target));
+}
+
+/************************************* | **************************************
+*                                                                             *
+* --profile-use: a virtual call whose targets are dominated by one method in  *
+* the profile tests for the class that selects that method and calls it       *
+* directly, falling back to the virtual call otherwise.                       *
+*                                                                             *
+* The profile counts calls per function rather than per call site, so this    *
+* is limited to methods selected by a single class, where the guard is one    *
+* class id comparison.                                                        *
+*                                                                             *
+************************************** | *************************************/
+
+// The hot target must receive at least this percentage of the calls
+static const int64_t kDominantTargetPercent = 90;
+
+static FnSymbol* dominantTarget(TargetMap&                    targets,
+                                std::map<FnSymbol*, int64_t>& fnCalls);
+
+static int       receiverFormalIndex(FnSymbol* fn);
+
+static bool      isGuardableStmt(CallExpr* call, Expr* stmt);
+
+void speculativelyDevirtualize(std::map<FnSymbol*, int64_t>& fnCalls) {
+  if (fNoDevirtualize == true) {
+    return;
+  }
+
+  computeDispatchTypes();
+
+  forv_Vec(CallExpr, call, gCallExprs) {
+    if (call->inTree() && call->isPrimitive(PRIM_VIRTUAL_METHOD_CALL)) {
+      FnSymbol* fn     = call->resolvedOrVirtualFunction();
+      int       index  = receiverFormalIndex(fn);
+      Expr*     _this  = call->get(index + 2);
+      Expr*     stmt   = call->getStmtExpr();
+      TargetMap targets;
+
+      if (isGuardableStmt(call, stmt)                        == true &&
+          virtualCallTargets(call, fn, _this, targets)       == true) {
+        FnSymbol* target = dominantTarget(targets, fnCalls);
+
+        if (target != NULL && targets[target].size() == 1) {
+          SET_LINENO(call);
+
+          AggregateType* at       = targets[target][0];
+          VarSymbol*     isTarget = newTemp("_virtual_method_guard_", dtBool);
+          BlockStmt*     thenStmt = new BlockStmt();
+          BlockStmt*     elseStmt = new BlockStmt();
+          CallExpr*      direct   = new CallExpr(target);
+          CallExpr*      testCid  = new CallExpr(PRIM_TESTCID,
+                                                 _this->copy(),
+                                                 at->symbol);
+
+          stmt->insertBefore(new DefExpr(isTarget));
+          stmt->insertBefore(new CallExpr(PRIM_MOVE, isTarget, testCid));
+          stmt->insertBefore(new CondStmt(new SymExpr(isTarget),
+                                          thenStmt,
+                                          elseStmt));
+
+          // The actuals of a virtual method call follow the function and
+          // the class id
+          for (int i = 3; i <= call->numActuals(); i++) {
+            direct->insertAtTail(call->get(i)->copy());
+          }
+
+          if (stmt == call) {
+            thenStmt->insertAtTail(direct);
+
+          } else {
+            CallExpr* move = toCallExpr(stmt);
+
+            thenStmt->insertAtTail(new CallExpr(move->primitive,
+                                                move->get(1)->copy(),
+                                                direct));
+          }
+
+          elseStmt->insertAtTail(stmt->remove());
+
+          bindToTarget(direct, target, direct->get(index));
+
+          if (fReportDevirtualizedCalls == true &&
+              (developer == true || printsUserLocation(call) == true)) {
+            USR_PRINT(call,
+                      "virtual call to '%s' is speculatively bound to '%s.%s'",
+                      fn->name,
+                      at->symbol->name,
+                      target->name);
+          }
+        }
+      }
+    }
+  }
+
+  clearDispatchTypes();
+}
+
+// Returns the target with the most calls, if it dominates the others
+static FnSymbol* dominantTarget(TargetMap&                    targets,
+                                std::map<FnSymbol*, int64_t>& fnCalls) {
+  FnSymbol* retval     = NULL;
+  int64_t   maxCalls   = 0;
+  int64_t   totalCalls = 0;
+
+  for (TargetMap::iterator it = targets.begin(); it != targets.end(); ++it) {
+    std::map<FnSymbol*, int64_t>::iterator count = fnCalls.find(it->first);
+    int64_t                                calls = 0;
+
+    if (count != fnCalls.end()) {
+      calls = count->second;
+    }
+
+    if (calls > maxCalls) {
+      retval   = it->first;
+      maxCalls = calls;
+    }
+
+    totalCalls += calls;
+  }
+
+  if (targets.size() < 2 ||
+      maxCalls * 100 < totalCalls * kDominantTargetPercent) {
+    retval = NULL;
+  }
+
+  return retval;
+}
+
+static int receiverFormalIndex(FnSymbol* fn) {
+  int retval = 1;
+
+  for_formals(formal, fn) {
+    if (formal == fn->_this) {
+      break;
+    }
+
+    retval++;
+  }
+
+  return retval;
+}
+
+// The statement is duplicated into both branches of the guard
+static bool isGuardableStmt(CallExpr* call, Expr* stmt) {
+  bool retval = false;
+
+  if (isBlockStmt(stmt->parentExpr) == true) {
+    if (stmt == call) {
+      retval = true;
+
+    } else if (CallExpr* move = toCallExpr(stmt)) {
+      retval = (move->isPrimitive(PRIM_MOVE)   == true ||
+                move->isPrimitive(PRIM_ASSIGN) == true) &&
+               move->get(2) == call;
+    }
+  }
+
+  return retval;
+}
@@ -71,6 +71,36 @@ static std::map<std::pair<BlockStmt*, BlockStmt*>, bool> scopeIsVisForMethods;
 static std::set<const char*> typeHelperNames;
 bool builtTypeHelperNames = false;
 
+/*
+   Memoized searches of module-level scopes.  Searching for a name from a
+   module block and up the visibility chain gives the same candidates for
+   every call inside that module, up to the privacy checks made against
+   the call.  So the result is recorded along with the blocks that were
+   searched and the outcome of each privacy check.  A later search can
+   reuse it as long as no module block has been searched yet for the
+   current call and the privacy checks come out the same.  The entries for
+   a name are dropped whenever buildVisibleFunctionMap() adds a function
+   with that name.
+ */
+typedef std::vector<std::pair<Symbol*, bool> > PrivacyChecks;
+
+class ModuleScopeCandidates {
+public:
+  std::vector<FnSymbol*>  fns;
+  std::vector<BlockStmt*> searched;
+  PrivacyChecks           privacyChecks;
+};
+
+typedef std::map<BlockStmt*, ModuleScopeCandidates> ModuleScopeMemo;
+
+static std::map<const char*, ModuleScopeMemo> moduleScopeMemo;
+
+static PrivacyChecks* privacyChecks = NULL;
+
+static int  nVisibleFunctionLookups = 0;
+static int  nModuleScopeSearches    = 0;
+static int  nModuleScopeMemoHits    = 0;
+
 
 /************************************* | **************************************
 *                                                                             *
@@ -191,6 +221,8 @@ static void buildVisibleFunctionMap() {
         vfb->visibleFunctions.put(fn->name, fns);
       }
       fns->add(fn);
+
+      moduleScopeMemo.erase(fn->name);
     }
   }
   nVisibleFunctions = gFnSymbols.n;
@@ -476,6 +508,8 @@ void getVisibleFunctions(const char*      name,
   BlockStmt*           block    = getVisibilityScope(call);
   std::set<BlockStmt*> visited;
 
+  nVisibleFunctionLookups++;
+
   getVisibleFunctions(name, call, block, visited, visibleFns, false);
 }
 
@@ -529,6 +563,16 @@ static void getVisibleFnsShowBlock(BlockStmt* block, ModuleSymbol* inMod,
   }
 }
 
+// Also records the outcome for a search of a module scope being memoized
+static bool isVisibleFromCall(Symbol* sym, CallExpr* call) {
+  bool retval = sym->isVisible(call);
+
+  if (privacyChecks != NULL && sym->hasFlag(FLAG_PRIVATE))
+    privacyChecks->push_back(std::make_pair(sym, retval));
+
+  return retval;
+}
+
 static void getVisibleFnsFirstVisit(const char*       name,
                                 CallExpr*             call,
                                 BlockStmt*            block,
@@ -560,7 +604,7 @@ static void getVisibleFnsFirstVisit(const char*       name,
             // We haven't checked the privacy of a function in this scope yet.
             // Do so now, and remember the result
             privacyChecked = true;
-            if (fn->isVisible(call)) {
+            if (isVisibleFromCall(fn, call)) {
               // We've determined that this function, even though it is
               // private, can be used
               visibleFns.add(fn);
@@ -626,7 +670,7 @@ static void getVisibleFnsFromUseList(const char*      name,
             // The use statement could be of an enum instead of a module,
             // but only modules can define functions.
 
-            if (mod->isVisible(call)) {
+            if (isVisibleFromCall(mod, call)) {
               if (use->isARenamedSym(name)) {
                 getVisibleFunctions(use->getRenamedSym(name),
                                     call, mod->block,
@@ -650,7 +694,7 @@ static void getVisibleFnsFromUseList(const char*      name,
           INT_ASSERT(se);
           ModuleSymbol* mod = toModuleSymbol(se->symbol());
           INT_ASSERT(mod);
-          if (mod->isVisible(call)) {
+          if (isVisibleFromCall(mod, call)) {
             if (import->isARenamedSym(name)) {
               getVisibleFunctions(import->getRenamedSym(name), call,
                                   mod->block, visited, visibleFns, true);
@@ -667,12 +711,125 @@ static void getVisibleFnsFromUseList(const char*      name,
   }
 }
 
+static void getVisibleFnsInBlock(const char*           name,
+                                 CallExpr*             call,
+                                 BlockStmt*            block,
+                                 std::set<BlockStmt*>& visited,
+                                 Vec<FnSymbol*>&       visibleFns,
+                                 bool                  inUseChain);
+
+static bool isModuleScope(BlockStmt* block) {
+  ModuleSymbol* mod = toModuleSymbol(block->parentSymbol);
+
+  return block->parentExpr == NULL && mod != NULL && block == mod->block;
+}
+
+static bool sameVisibility(const PrivacyChecks& checks, CallExpr* call) {
+  for (PrivacyChecks::const_iterator it = checks.begin();
+       it != checks.end();
+       ++it) {
+    if (it->first->isVisible(call) != it->second)
+      return false;
+  }
+
+  return true;
+}
+
+// Searching from a module block only ever reaches other module blocks
+static bool searchedModuleScope(const std::set<BlockStmt*>& visited) {
+  for_set(BlockStmt, block, visited) {
+    if (isModuleScope(block))
+      return true;
+  }
+
+  return false;
+}
+
+//
+// Search a module block that was reached by going up in scope from the
+// call, reusing or recording the result in 'moduleScopeMemo'.
+//
+static void getMemoizedVisibleFns(const char*           name,
+                                  CallExpr*             call,
+                                  BlockStmt*            block,
+                                  std::set<BlockStmt*>& visited,
+                                  Vec<FnSymbol*>&       visibleFns) {
+  ModuleScopeMemo&          memo  = moduleScopeMemo[name];
+  ModuleScopeMemo::iterator it    = memo.find(block);
+  ModuleScopeCandidates*    found = NULL;
+  bool                      hit   = false;
+
+  nModuleScopeSearches++;
+
+  if (it != memo.end()) {
+    found = &it->second;
+    hit   = sameVisibility(found->privacyChecks, call);
+  }
+
+  if (hit == false) {
+    // Search the module as if it were the call's own scope.  'memo' may
+    // gain entries for enclosing modules meanwhile, but std::map
+    // references stay valid across insertions.
+    ModuleScopeCandidates& fresh     = memo[block];
+    PrivacyChecks*         outer     = privacyChecks;
+    std::set<BlockStmt*>   searched;
+    Vec<FnSymbol*>         fns;
+
+    fresh.privacyChecks.clear();
+
+    privacyChecks = &fresh.privacyChecks;
+
+    getVisibleFnsInBlock(name, call, block, searched, fns, false);
+
+    privacyChecks = outer;
+
+    fresh.fns.assign(fns.v, fns.v + fns.n);
+    fresh.searched.assign(searched.begin(), searched.end());
+
+    found = &fresh;
+  }
+
+  if (hit)
+    nModuleScopeMemoHits++;
+
+  for_vector(FnSymbol, fn, found->fns) {
+    visibleFns.add(fn);
+  }
+
+  visited.insert(found->searched.begin(), found->searched.end());
+
+  // An enclosing search that is being recorded depends on the same checks
+  if (privacyChecks != NULL) {
+    privacyChecks->insert(privacyChecks->end(),
+                          found->privacyChecks.begin(),
+                          found->privacyChecks.end());
+  }
+}
+
 static void getVisibleFunctions(const char*           name,
                                 CallExpr*             call,
                                 BlockStmt*            block,
                                 std::set<BlockStmt*>& visited,
                                 Vec<FnSymbol*>&       visibleFns,
                                 bool                  inUseChain)
+{
+  if (inUseChain == false                   &&
+      call->id   != breakOnResolveID        &&
+      isModuleScope(block)                  &&
+      searchedModuleScope(visited) == false) {
+    getMemoizedVisibleFns(name, call, block, visited, visibleFns);
+
+  } else {
+    getVisibleFnsInBlock(name, call, block, visited, visibleFns, inUseChain);
+  }
+}
+
+static void getVisibleFnsInBlock(const char*           name,
+                                 CallExpr*             call,
+                                 BlockStmt*            block,
+                                 std::set<BlockStmt*>& visited,
+                                 Vec<FnSymbol*>&       visibleFns,
+                                 bool                  inUseChain)
 {
   const bool firstVisit = (visited.find(block) == visited.end());
 
@@ -855,6 +1012,21 @@ void visibleFunctionsClear() {
   }
 
   visibleFunctionMap.clear();
+
+  if (fPrintStatistics[0] != '\0' && nModuleScopeSearches > 0) {
+    fprintf(stderr,
+            "%7d visible function lookups, "
+            "%d of %d module scope searches memoized (%.1f%%)\n",
+            nVisibleFunctionLookups,
+            nModuleScopeMemoHits, nModuleScopeSearches,
+            100.0 * nModuleScopeMemoHits / nModuleScopeSearches);
+  }
+
+  moduleScopeMemo.clear();
+
+  nVisibleFunctionLookups = 0;
+  nModuleScopeSearches    = 0;
+  nModuleScopeMemoHits    = 0;
 }
 
 /************************************* | **************************************
@@ -55,6 +55,7 @@
 
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <utime.h>
 
 char executableFilename[FILENAME_MAX + 1] = "";
 char libmodeHeadername[FILENAME_MAX + 1]  = "";
@@ -336,6 +337,67 @@ void closefile(fileinfo* thefile) {
 }
 
 
+//
+// With --savec the generated files persist between compilations.  A file
+// that is regenerated with identical contents gets its old timestamps back
+// so that the generated Makefile only recompiles what actually changed.
+//
+struct PreviousCFile {
+  std::string    contents;
+  struct utimbuf times;
+};
+
+static std::map<std::string, PreviousCFile> previousCFiles;
+
+static bool readFileContents(const char* pathname, std::string& contents) {
+  FILE* fp = fopen(pathname, "rb");
+
+  if (fp == NULL) {
+    return false;
+  }
+
+  char   buf[65536];
+  size_t len = 0;
+
+  contents.clear();
+
+  while ((len = fread(buf, 1, sizeof(buf), fp)) > 0) {
+    contents.append(buf, len);
+  }
+
+  fclose(fp);
+
+  return true;
+}
+
+static void rememberPreviousCFile(const char* pathname) {
+  struct stat   st;
+  PreviousCFile prev;
+
+  if (stat(pathname, &st) == 0 && readFileContents(pathname, prev.contents)) {
+    prev.times.actime  = st.st_atime;
+    prev.times.modtime = st.st_mtime;
+
+    previousCFiles[pathname] = prev;
+  }
+}
+
+static void restoreTimesIfUnchanged(const char* pathname) {
+  std::map<std::string, PreviousCFile>::iterator it;
+  std::string                                    contents;
+
+  it = previousCFiles.find(pathname);
+
+  if (it != previousCFiles.end()) {
+    if (readFileContents(pathname, contents) &&
+        contents == it->second.contents) {
+      utime(pathname, &it->second.times);
+    }
+
+    previousCFiles.erase(it);
+  }
+}
+
 void openCFile(fileinfo* fi, const char* name, const char* ext) {
   if (ext)
     fi->filename = astr(name, ".", ext);
@@ -343,6 +405,10 @@ void openCFile(fileinfo* fi, const char* name, const char* ext) {
     fi->filename = astr(name);
 
   fi->pathname = genIntermediateFilename(fi->filename);
+
+  if (saveCDir[0] != '\0')
+    rememberPreviousCFile(fi->pathname);
+
   openfile(fi, "w");
 }
 
@@ -362,6 +428,9 @@ void closeCFile(fileinfo* fi, bool beautifyIt) {
   //
   if (beautifyIt && (saveCDir[0] || printCppLineno))
     beautify(fi);
+
+  if (saveCDir[0] != '\0')
+    restoreTimesIfUnchanged(fi->pathname);
 }
 
 fileinfo* openTmpFile(const char* tmpfilename, const char* mode) {
@@ -53,6 +53,9 @@ static int         err_fatal        =    0;
 static int         err_user         =    0;
 static int         err_print        =    0;
 static int         err_ignore       =    0;
+static int         err_warning      =    0;
+
+static bool        warnings_encountered = false;
 
 static FnSymbol*   err_fn           = NULL;
 static int         err_fn_id        = 0;
@@ -75,6 +78,7 @@ void setupError(const char* subdir, const char* filename, int lineno, int tag) {
   err_user          = tag != 1;
   err_print         = tag == 5;
   err_ignore        = ignore_warnings && tag == 4;
+  err_warning       = tag == 4;
 
   exit_immediately  = tag == 1 || tag == 2;
   exit_eventually  |= tag == 3;
@@ -593,6 +597,10 @@ static void vhandleError(const BaseAST* ast,
     return;
   }
 
+  if (err_warning) {
+    warnings_encountered = true;
+  }
+
   bool guess = false;
 
   guess = printErrorHeader(const_cast<BaseAST*>(ast), astloc);
@@ -655,6 +663,10 @@ bool fatalErrorsEncountered() {
   return exit_eventually || exit_end_of_pass;
 }
 
+bool warningsEncountered() {
+  return warnings_encountered;
+}
+
 void clearFatalErrors() {
   exit_eventually = false;
   exit_end_of_pass = false;
@@ -0,0 +1,216 @@
+/*
+ * Copyright 2020 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Used by the compiler to aggregate fine-grained updates in foralls
+//
+// With --auto-aggregation, a forall loop whose body ends in
+//
+//   A[i] = v;          or          A[i].add(v);
+//
+// where 'A' is not otherwise referenced by the loop, gets a task-private
+// chpl__DstAggregator initialized by chpl__dstAggregatorFor() and that
+// statement becomes a call to its copy() or add() method, guarded by the
+// param chpl__isAggregatable() so that other kinds of 'A' keep the
+// original statement.  See compiler/optimizations/autoAggregation.cpp.
+//
+// Updates that target the current locale are applied right away.  The
+// others are buffered per destination locale, and a full buffer is
+// shipped with a single on-statement that pulls it over in bulk and
+// applies it there.  Whatever is left is applied when the task ends and
+// its aggregator is deinitialized, before the forall completes.
+//
+// A loop ending in 'B[i] = A[j]' similarly gets a chpl__SrcAggregator
+// from chpl__srcAggregatorFor(), guarded by chpl__isGatherable().  It
+// buffers the addresses of remote elements of 'A' per source locale, and
+// a single on-statement per full buffer reads them there and puts the
+// values back in bulk, after which they are stored into 'B'.
+//
+module ChapelAutoAggregation {
+  use ChapelLocale;
+  use CPtr;
+
+  param chpl__aggregationBufferSize = 1024;
+
+  proc chpl__isAggregatable(const ref A, param isAdd: bool) param {
+    if !isArray(A) then
+      return false;
+    else if A._value.isDefaultRectangular() then
+      return false;
+    else if isAdd then
+      return isAtomicType(A.eltType) && isPODType(A.eltType.T);
+    else
+      return isPODType(A.eltType);
+  }
+
+  // 'gathered' is set when a chpl__SrcAggregator takes this statement
+  proc chpl__dstAggregatorFor(const ref A, param isAdd: bool,
+                              param gathered = false) {
+    if gathered || !chpl__isAggregatable(A, isAdd) then
+      return new chpl__noAggregator();
+    else if isAdd then
+      return new chpl__DstAggregator(A.eltType, A.eltType.T, true);
+    else
+      return new chpl__DstAggregator(A.eltType, A.eltType, false);
+  }
+
+  proc chpl__isGatherable(const ref A, const ref B) param {
+    if !isArray(A) || !isArray(B) then
+      return false;
+    else if A._value.isDefaultRectangular() then
+      return false;
+    else
+      return A.eltType == B.eltType && isPODType(A.eltType);
+  }
+
+  proc chpl__srcAggregatorFor(const ref A, const ref B) {
+    if !chpl__isGatherable(A, B) then
+      return new chpl__noAggregator();
+    else
+      return new chpl__SrcAggregator(A.eltType);
+  }
+
+  // The task-private variable for loops that keep the original statement
+  record chpl__noAggregator {
+  }
+
+  record chpl__DstAggregator {
+    type eltType;
+    type valType;
+    param isAdd: bool;
+
+    var bufs: [LocaleSpace] [0..#chpl__aggregationBufferSize]
+                            (c_void_ptr, valType);
+    var counts: [LocaleSpace] int;
+
+    proc ref deinit() {
+      for loc in LocaleSpace do
+        flush(loc);
+    }
+
+    inline proc ref copy(ref dst: eltType, const in src: valType) {
+      const loc = __primitive("_wide_get_node", dst): int;
+
+      if loc == chpl_nodeID: int then
+        dst = src;
+      else
+        buffer(loc, __primitive("_wide_get_addr", dst), src);
+    }
+
+    inline proc ref add(ref dst: eltType, const in src: valType) {
+      const loc = __primitive("_wide_get_node", dst): int;
+
+      if loc == chpl_nodeID: int then
+        dst.add(src);
+      else
+        buffer(loc, __primitive("_wide_get_addr", dst), src);
+    }
+
+    inline proc ref buffer(loc: int, addr: c_void_ptr, const in val: valType) {
+      ref n = counts[loc];
+
+      bufs[loc][n] = (addr, val);
+      n += 1;
+
+      if n == chpl__aggregationBufferSize then
+        flush(loc);
+    }
+
+    proc ref flush(loc: int) {
+      const n = counts[loc];
+
+      if n == 0 then
+        return;
+
+      on Locales[loc] {
+        // One bulk GET of the origin's buffer, then local updates
+        const updates: [0..#n] (c_void_ptr, valType) = bufs[loc][0..#n];
+
+        for (addr, val) in updates {
+          ref elt = (addr: c_ptr(eltType)).deref();
+
+          if isAdd then
+            elt.add(val);
+          else
+            elt = val;
+        }
+      }
+
+      counts[loc] = 0;
+    }
+  }
+
+  record chpl__SrcAggregator {
+    type eltType;
+
+    var dsts: [LocaleSpace] [0..#chpl__aggregationBufferSize] c_void_ptr;
+    var srcs: [LocaleSpace] [0..#chpl__aggregationBufferSize] c_void_ptr;
+    var counts: [LocaleSpace] int;
+
+    proc ref deinit() {
+      for loc in LocaleSpace do
+        flush(loc);
+    }
+
+    inline proc ref copy(ref dst: eltType, const ref src: eltType) {
+      const loc = __primitive("_wide_get_node", src): int;
+
+      // Only stores into this locale can be buffered by address
+      if loc == chpl_nodeID: int ||
+         __primitive("_wide_get_node", dst): int != chpl_nodeID: int {
+        dst = src;
+      } else {
+        ref n = counts[loc];
+
+        dsts[loc][n] = __primitive("_wide_get_addr", dst);
+        srcs[loc][n] = __primitive("_wide_get_addr", src);
+        n += 1;
+
+        if n == chpl__aggregationBufferSize then
+          flush(loc);
+      }
+    }
+
+    proc ref flush(loc: int) {
+      const n = counts[loc];
+
+      if n == 0 then
+        return;
+
+      var vals: [0..#n] eltType;
+
+      on Locales[loc] {
+        // One bulk GET of the addresses and one bulk PUT of the values
+        const addrs: [0..#n] c_void_ptr = srcs[loc][0..#n];
+        var fetched: [0..#n] eltType;
+
+        for (val, addr) in zip(fetched, addrs) do
+          val = (addr: c_ptr(eltType)).deref();
+
+        vals = fetched;
+      }
+
+      for (addr, val) in zip(dsts[loc][0..#n], vals) do
+        (addr: c_ptr(eltType)).deref() = val;
+
+      counts[loc] = 0;
+    }
+  }
+}
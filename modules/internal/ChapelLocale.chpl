@@ -906,6 +906,55 @@ module ChapelLocale {
     here.runningTaskCntSet(0);
   }
 
+  //
+  // Support for tree-structured coforall+on launches.
+  //
+  // The compiler rewrites 'coforall loc in A do on loc { ... }' over a
+  // 1-D array of locales so that, when the array is large enough, the
+  // initiating locale only forks onto A's first element.  Each locale
+  // then runs its own iteration and forwards the rest of its index
+  // range to (at most) two children, so the launch takes O(log P)
+  // sequential remote forks rather than O(P).
+  //
+  pragma "no doc"
+  config param chpl_coforallOnTree = true;
+
+  pragma "no doc"
+  config param chpl_coforallOnTreeMinLocales = 32;
+
+  pragma "no doc"
+  proc chpl__coforallOnTreeOk(x) param {
+    if !chpl_coforallOnTree || !isArray(x) {
+      return false;
+    } else if !isRectangularArr(x) {
+      return false;
+    } else {
+      return x.rank == 1 && x.eltType == locale;
+    }
+  }
+
+  pragma "no doc"
+  inline proc chpl__coforallOnTreeUse(x) {
+    return x.size >= max(1, chpl_coforallOnTreeMinLocales);
+  }
+
+  // Return the k-th element of the locale array, counting from 0.
+  pragma "no doc"
+  inline proc chpl__coforallOnTreeElem(x, k: int) {
+    return x[x.domain.dim(0).orderToIndex(k)];
+  }
+
+  // The subtree rooted at 'lo' covers [lo, hi).  Yield the ranges of
+  // its children, each as (first, end), splitting (lo, hi) in half.
+  pragma "no doc"
+  iter chpl__coforallOnTreeChildren(lo: int, hi: int) {
+    const mid = lo + 1 + (hi - lo) / 2;
+    if lo + 1 < mid then
+      yield (lo + 1, mid);
+    if mid < hi then
+      yield (mid, hi);
+  }
+
   pragma "no doc"
   proc deinit() {
     delete origRootLocale._instance;
@@ -62,6 +62,7 @@ module ChapelStandard {
   use ChapelError;
   use ChapelTaskData;
   use ChapelSerializedBroadcast;
+  use ChapelAutoAggregation;
   use ExportWrappers;
 
   // Standard modules.
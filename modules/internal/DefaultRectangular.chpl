@@ -1169,6 +1169,30 @@ module DefaultRectangular {
                            followThis);
       }
 
+      // Unit-stride fast path for multidimensional row-major arrays:
+      // compute the data index once per row and walk the row
+      // contiguously, so the innermost loop has no index arithmetic
+      // beyond an increment and can be vectorized.  The order matches
+      // the domain follower's.
+      if rank > 1 && !stridable && !chpl__anyStridable(followThis) &&
+         storageOrder == ArrayStorageOrder.RMO && !usePollyArrayIndex {
+        if chpl__testParFlag then
+          chpl__testPar("default rectangular domain follower invoked on ", followThis);
+        var outer: (rank-1)*range(intIdxType);
+        for param i in 0..rank-2 do
+          outer(i) = dom.ranges(i)._low+followThis(i).low:intIdxType..dom.ranges(i)._low+followThis(i).high:intIdxType;
+        const innerLow = dom.ranges(rank-1)._low+followThis(rank-1).low:intIdxType,
+              innerSize = followThis(rank-1).size:intIdxType;
+
+        for i in dom.these_help(0, outer) {
+          const rowStart = if rank == 2 then getDataIndex(dom.chpl_intToIdx((i, innerLow)))
+                           else getDataIndex(dom.chpl_intToIdx(((...i), innerLow)));
+          for j in rowStart..#innerSize do
+            yield theData(j);
+        }
+        return;
+      }
+
       for i in dom.these(tag=iterKind.follower, followThis,
                          tasksPerLocale,
                          ignoreRunning,
@@ -0,0 +1,47 @@
+/*
+ * Copyright 2020 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _chpl_fn_profile_h_
+#define _chpl_fn_profile_h_
+
+#include "chplcgfns.h"
+
+//
+// Programs compiled with --profile-gen count the calls to each of their
+// functions and write the counts out when they exit, for a later
+// compile with --profile-use to base its inlining decisions on.
+//
+
+static inline
+void chpl_fnProfileCount(int32_t idx) {
+  (void) __sync_fetch_and_add(&chpl_fnProfileCounts[idx], 1);
+}
+
+// Writes the call counts to chpl_fnProfileFile, if there are any
+void chpl_fnProfileWrite(void);
+
+// Applied to the functions --profile-use found were never called
+#ifdef __GNUC__
+#define CHPL_COLD_FN __attribute__((cold, noinline))
+#else
+#define CHPL_COLD_FN
+#endif
+
+#endif // _chpl_fn_profile_h_
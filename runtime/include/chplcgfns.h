@@ -83,6 +83,15 @@ extern const c_string chpl_funSymTable[];
 extern const int chpl_filenumSymTable[];
 extern const int32_t chpl_sizeSymTable;
 
+// Per-function call counters and their function ids and names, used by
+// programs compiled with --profile-gen.  chpl_fnProfileNumFns is 0 when
+// the program is not instrumented.
+extern int64_t chpl_fnProfileCounts[];
+extern const int32_t chpl_fnProfileIds[];
+extern const char* chpl_fnProfileNames[];
+extern const int32_t chpl_fnProfileNumFns;
+extern const char* chpl_fnProfileFile;
+
 extern char* chpl_executionCommand;
 
 /* generated */
@@ -0,0 +1,59 @@
+/*
+ * Copyright 2020 Hewlett Packard Enterprise Development LP
+ * Copyright 2004-2019 Cray Inc.
+ * Other additional copyright holders may be indicated within.
+ *
+ * The entirety of this work is licensed under the Apache License,
+ * Version 2.0 (the "License"); you may not use this file except
+ * in compliance with the License.
+ *
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "chplrt.h"
+
+#include "chplcgfns.h"
+#include "chpl-comm.h"
+#include "chpl-fn-profile.h"
+#include "error.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+
+//
+// The format is read back by the compiler under --profile-use: one
+// "<function id> <calls> <function name>" line per function, after a
+// comment line.  Only the calls made on locale 0 are counted.
+//
+void chpl_fnProfileWrite(void) {
+  FILE* f;
+  int32_t i;
+
+  if (chpl_fnProfileNumFns == 0 || chpl_nodeID != 0)
+    return;
+
+  if ((f = fopen(chpl_fnProfileFile, "w")) == NULL) {
+    char msg[256];
+    snprintf(msg, sizeof(msg), "unable to write function call counts to '%s'",
+             chpl_fnProfileFile);
+    chpl_warning(msg, 0, 0);
+    return;
+  }
+
+  fprintf(f, "# function call counts: <id> <calls> <name>\n");
+  for (i = 0; i < chpl_fnProfileNumFns; i++) {
+    fprintf(f, "%" PRId32 " %" PRId64 " %s\n",
+            chpl_fnProfileIds[i], chpl_fnProfileCounts[i],
+            chpl_fnProfileNames[i]);
+  }
+
+  fclose(f);
+}
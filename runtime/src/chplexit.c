@@ -23,6 +23,7 @@
 #include "chpl_rt_utils_static.h"
 #include "chpl-comm.h"
 #include "chplexit.h"
+#include "chpl-fn-profile.h"
 #include "chpl-mem.h"
 #include "chplmemtrack.h"
 #include "chpl-topo.h"
@@ -40,6 +41,7 @@ static void chpl_exit_common(int status, int all) {
   chpl_comm_pre_task_exit(all);
   if (all) {
     chpl_task_exit();
+    chpl_fnProfileWrite();
     chpl_reportMemInfo();
   }
   chpl_comm_exit(all, status);
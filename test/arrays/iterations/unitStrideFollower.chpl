@@ -0,0 +1,31 @@
+// Zippered foralls over multidimensional arrays take the unit-stride
+// follower path; make sure elements still line up with indices, also
+// when following a strided domain or an array with different bounds.
+
+config const n = 7;
+
+proc check(A, D) {
+  var bad = 0;
+  forall (a, i) in zip(A, D) with (+ reduce bad) do
+    if a != i then bad += 1;
+  forall (i, a) in zip(D, A) with (+ reduce bad) do
+    if a != i then bad += 1;
+  return bad;
+}
+
+{
+  const D = {1..n, 0..n+2};
+  var A: [D] 2*int;
+  forall i in D do A[i] = i;
+  var B: [0..n-1, 2..n+4] 2*int;
+  forall (b, a) in zip(B, A) do b = a;
+  writeln("2D: ", check(A, D), " ", check(B, D), " ", + reduce [b in B] b(0));
+  writeln("2D strided: ", check(A[1..n by 2, 1..n by 3], D[1..n by 2, 1..n by 3]));
+}
+
+{
+  const D = {1..3, 1..n, -2..n};
+  var A: [D] 3*int;
+  forall i in D do A[i] = i;
+  writeln("3D: ", check(A, D), " ", check(A[2..3, 2..n-1, 0..1], D[2..3, 2..n-1, 0..1]));
+}
@@ -0,0 +1 @@
+writeln("Hello from a compile cache test");
@@ -0,0 +1,15 @@
+// With --incremental each user module is its own translation unit, and
+// the back-end compiles them as independent make targets.
+module Helper {
+  proc helperValue() {
+    return 42;
+  }
+}
+
+module parallelModules {
+  use Helper;
+
+  proc main() {
+    writeln("helperValue() = ", helperValue());
+  }
+}
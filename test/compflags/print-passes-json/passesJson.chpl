@@ -0,0 +1 @@
+writeln("Hello from a pass statistics test");
@@ -0,0 +1,28 @@
+use BlockDist;
+
+config const n = 10000;
+
+const D = {0..#n} dmapped Block({0..#n});
+
+var A: [D] int = [i in D] i * i;
+var idx: [D] int = [i in D] (i * 7919) % n;
+
+// A gather into a distributed array: aggregated
+var B: [D] int;
+forall i in D do B[i] = A[idx[i]];
+writeln(&& reduce [i in D] B[i] == idx[i] * idx[i]);
+
+// A gather into a local array: aggregated
+var L: [0..#n] int;
+forall i in D do L[i] = A[idx[i]];
+writeln(&& reduce [i in D] L[i] == B[i]);
+
+// The element types differ: not aggregated
+var R: [D] real;
+forall i in D do R[i] = A[idx[i]];
+writeln(+ reduce R == + reduce B);
+
+// 'A' is mentioned again in the loop: not aggregated
+var C: [D] int;
+forall i in D do C[i] = A[A.size - 1 - i];
+writeln(C[0] == (n - 1) * (n - 1));
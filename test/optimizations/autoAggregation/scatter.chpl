@@ -0,0 +1,29 @@
+use BlockDist;
+
+config const n = 10000;
+
+const D = {0..#n} dmapped Block({0..#n});
+
+var idx: [D] int;
+forall i in D do idx[i] = (i * 7919) % n;
+
+// A scatter: aggregated
+var A: [D] int;
+forall i in D do A[idx[i]] = i;
+writeln(+ reduce A == n * (n - 1) / 2);
+writeln(&& reduce [i in D] A[idx[i]] == i);
+
+// A histogram of atomics: aggregated
+var H: [D] atomic int;
+forall i in D do H[idx[i] % 100].add(1);
+writeln(+ reduce [h in H] h.read());
+
+// A local array: not aggregated
+var L: [0..#n] int;
+forall i in D do L[idx[i]] = i;
+writeln(+ reduce L == n * (n - 1) / 2);
+
+// 'B' is mentioned again in the loop: not aggregated
+var B: [D] int;
+forall i in D do B[idx[i]] = B.size;
+writeln(+ reduce B == n * n);
@@ -0,0 +1,30 @@
+// Check that 'coforall loc in A do on loc' launched as a tree runs every
+// iteration once on the right locale, and gathers errors like the flat
+// launch does.  The sizes cover a leaf-only tree and uneven splits.
+
+for n in (1, 2, 5, 17) {
+  var A: [0..#n] locale = [i in 0..#n] Locales[i % numLocales];
+  var B: [1..n] locale = A;
+  var hits, wrong, hitsB: atomic int;
+
+  coforall loc in A do on loc {
+    hits.add(1);
+    if here != loc then wrong.add(1);
+  }
+  coforall loc in B do on loc {
+    if here == loc then hitsB.add(1);
+  }
+
+  try {
+    coforall loc in A do on loc {
+      throw new Error("boom");
+    }
+  } catch e: TaskErrors {
+    var count = 0;
+    for err in e do count += 1;
+    writeln(n, ": hits=", hits.read(), " wrong=", wrong.read(),
+            " hitsB=", hitsB.read(), " errors=", count);
+  } catch {
+    writeln("unexpected error");
+  }
+}
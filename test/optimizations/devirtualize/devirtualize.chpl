@@ -0,0 +1,76 @@
+class Shape {
+  proc area(): real {
+    return 0.0;
+  }
+}
+
+class Circle: Shape {
+  var r: real;
+
+  override proc area(): real {
+    return 3.0 * r * r;
+  }
+}
+
+// Only ever nil, so calls on a Circle can only reach Circle.area
+class Ring: Circle {
+  var inner: real;
+
+  override proc area(): real {
+    return 3.0 * (r * r - inner * inner);
+  }
+}
+
+class Square: Shape {
+  var s: real;
+
+  override proc area(): real {
+    return s * s;
+  }
+}
+
+// Named.kind() runs while 'this' is still a Named,
+// so calls that may run within an initializer stay virtual
+class Named {
+  proc init() {
+    this.complete();
+    writeln("initializing ", kind());
+  }
+
+  proc kind(): string {
+    return "named";
+  }
+}
+
+class Tagged: Named {
+  proc init() {
+    super.init();
+  }
+
+  override proc kind(): string {
+    return "tagged";
+  }
+}
+
+proc circleArea(c: borrowed Circle) {
+  return c.area();
+}
+
+proc shapeArea(s: borrowed Shape) {
+  return s.area();
+}
+
+proc describe(n: borrowed Named) {
+  return n.kind();
+}
+
+var noRing: owned Ring?;
+var c = new owned Circle(2.0);
+var q = new owned Square(3.0);
+
+writeln(circleArea(c));
+writeln(shapeArea(c), " ", shapeArea(q));
+
+var t = new owned Tagged();
+
+writeln(describe(t));
@@ -0,0 +1,42 @@
+// speculative.precomp compiles and runs this program with --profile-gen;
+// almost all of the calls to area() in the training run go to Circle.area
+
+class Shape {
+  proc area(): real {
+    return 0.0;
+  }
+}
+
+class Circle: Shape {
+  var r: real;
+
+  override proc area(): real {
+    return 3.0 * r * r;
+  }
+}
+
+class Square: Shape {
+  var s: real;
+
+  override proc area(): real {
+    return s * s;
+  }
+}
+
+proc totalArea(shapes: [] owned Shape) {
+  var total = 0.0;
+
+  for s in shapes do
+    total += s.area();
+
+  return total;
+}
+
+config const n = 1000;
+
+var shapes: [1..n] owned Shape = [i in 1..n] if i % 100 == 0
+                                             then new owned Square(2.0): owned Shape
+                                             else new owned Circle(1.0): owned Shape;
+
+for 1..10 do
+  writeln(totalArea(shapes));
@@ -0,0 +1,20 @@
+// profileUse.precomp compiles and runs this program with --profile-gen;
+// the counts it writes make square() hot enough to be inlined.
+
+proc square(x: int) {
+  return x * x;
+}
+
+proc report(x: int) {
+  writeln("negative sum ", x);
+}
+
+var sum = 0;
+
+for i in 1..100000 do
+  sum += square(i % 100);
+
+if sum < 0 then
+  report(sum);
+
+writeln(sum);
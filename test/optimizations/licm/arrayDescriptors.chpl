@@ -0,0 +1,41 @@
+// Loads of array descriptor fields are hoisted out of loops that cannot
+// reallocate the array.  Check results for stencil-like loop nests, and
+// that a loop which resizes the domain still sees the new layout.
+
+config const n = 6;
+
+proc stencil(ref A: [] real, const ref B: [] real) {
+  for i in 1..n do
+    for j in 1..n do
+      A[i, j] = B[i-1, j] + B[i+1, j] + B[i, j-1] + B[i, j+1];
+}
+
+var D = {0..n+1, 0..n+1};
+var A, B: [D] real;
+for (i, j) in D do B[i, j] = i * 10 + j;
+stencil(A, B);
+writeln(+ reduce A);
+
+var C: [1..3, 0..n by 2, -1..n] int;
+for i in 1..3 do
+  for j in 0..n by 2 do
+    for k in -1..n do
+      C[i, j, k] = i * 10000 + j * 100 + k;
+var bad = 0;
+for (i, j, k) in C.domain do
+  if C[i, j, k] != i * 10000 + j * 100 + k then bad += 1;
+var i = 1;
+while i <= n {
+  B[i, i] = C[3, 2, i];
+  i += 1;
+}
+writeln(bad, " ", B[n, n]);
+
+var R = {1..2, 1..2};
+var E: [R] int;
+for k in 3..5 {
+  R = {1..k, 1..k};
+  for j in 1..k do
+    E[k, j] = k * j;
+}
+writeln(E);
@@ -0,0 +1,42 @@
+// Loop invariant code motion and dead block elimination analyze functions
+// on several threads; the hoisting must come out the same as with one.
+
+config const n = 5;
+
+proc sumScaled(A: [] int, x: int, y: int) {
+  var sum = 0;
+  for i in A.domain {
+    // 'x * y + 1' is invariant in this loop
+    const scale = x * y + 1;
+    sum += A[i] * scale;
+  }
+  return sum;
+}
+
+proc countDown(start: int) {
+  var i = start;
+  var steps = 0;
+  while i > 0 {
+    const limit = start * 2;
+    if i < limit then steps += 1;
+    i -= 1;
+  }
+  return steps;
+}
+
+proc nested(m: int) {
+  var total = 0;
+  for i in 1..m {
+    for j in 1..m {
+      const base = m * m;
+      total += base + i * j;
+    }
+  }
+  return total;
+}
+
+var A: [1..n] int = [i in 1..n] i;
+
+writeln(sumScaled(A, 2, 3));
+writeln(countDown(n));
+writeln(nested(n));
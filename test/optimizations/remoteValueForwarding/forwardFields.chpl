@@ -0,0 +1,45 @@
+class Inner {
+  const n: int;
+  var scale: real;
+}
+
+record Cfg {
+  var name: int;
+  var inner: unmanaged Inner;
+  var D: domain(1);
+}
+
+class Holder {
+  const cfg: Cfg;
+  var count: int;
+}
+
+proc main() {
+  var h = new unmanaged Holder(new Cfg(1, new unmanaged Inner(5, 2.0), {1..10}));
+
+  // Read-only fields, including a domain, are read before the on-statement
+  on Locales[numLocales-1] {
+    writeln(h.cfg.inner.n + h.cfg.name, " ", h.cfg.D.size);
+  }
+
+  // 'count' and 'scale' are written, so they are read inside the body
+  h.count = 3;
+  h.cfg.inner.scale = 4.0;
+  on Locales[numLocales-1] {
+    writeln(h.count, " ", h.cfg.inner.scale);
+  }
+
+  // The body runs where 'h' lives, so nothing is forwarded
+  on h {
+    writeln(h.cfg.name);
+  }
+
+  // Reads that may not happen are not forwarded
+  on Locales[numLocales-1] {
+    if h.cfg.inner != nil then
+      writeln(h.cfg.inner.n);
+  }
+
+  delete h.cfg.inner;
+  delete h;
+}
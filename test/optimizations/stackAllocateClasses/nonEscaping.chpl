@@ -0,0 +1,93 @@
+// Class instances that do not outlive the block that creates them
+// are allocated on the stack; the others stay on the heap.
+
+var numDeinits = 0;
+var saved: unmanaged Pt?;
+
+class Pt {
+  var x, y: int;
+  proc norm() return x*x + y*y;
+}
+
+class Counted {
+  var id: int;
+  proc deinit() { numDeinits += 1; }
+}
+
+proc sumOwned(n: int) {
+  var s = 0;
+  for i in 1..n {
+    var p = new owned Pt(i, i+1);
+    s += p.norm();
+    p.x += 1;
+    s += p.x;
+  }
+  return s;
+}
+
+proc sumUnmanaged(n: int) {
+  var s = 0;
+  for i in 1..n {
+    var p = new unmanaged Pt(i, i);
+    s += p.norm();
+    delete p;
+  }
+  return s;
+}
+
+proc countDeinits(n: int) {
+  for i in 1..n {
+    var c = new owned Counted(i);
+    var b = c.borrow();
+    if b.id != i then halt("wrong id");
+  }
+}
+
+proc identity(p: borrowed Pt) return p;
+
+proc throughCall() {
+  var p = new owned Pt(3, 4);
+  return identity(p.borrow()).norm();
+}
+
+// These escape
+
+proc returned() {
+  return new owned Pt(1, 2);
+}
+
+proc stored(i: int) {
+  var p = new unmanaged Pt(i, i);
+  saved = p;
+}
+
+proc keepAcross(n: int) {
+  var last: unmanaged Pt?;
+  for i in 1..n {
+    var p = new unmanaged Pt(i, i);
+    delete last;
+    last = p;
+  }
+  const ret = last!.x;
+  delete last;
+  return ret;
+}
+
+proc intoTask() {
+  var p = new owned Pt(5, 6);
+  var s: int;
+  sync { begin with (ref s) s = p.norm(); }
+  return s;
+}
+
+writeln(sumOwned(10));
+writeln(sumUnmanaged(10));
+countDeinits(7);
+writeln(numDeinits);
+writeln(throughCall());
+writeln(returned().norm());
+stored(4);
+writeln(saved!.norm());
+delete saved;
+writeln(keepAcross(5));
+writeln(intoTask());
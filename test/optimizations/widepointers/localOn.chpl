@@ -0,0 +1,30 @@
+//
+// An on-statement targeting an object created on 'here' runs on the
+// current locale, so neither its body nor what it calls needs to be wide.
+//
+
+class C {
+  var x: int;
+}
+
+proc bump(c: C) {
+  c.x += 1;
+  writeln("is 'c' wide in bump? ", __primitive("is wide pointer", c));
+}
+
+proc main() {
+  var loc = new unmanaged C(1);
+  on loc {
+    bump(loc);
+    writeln("is 'loc' wide in on? ", __primitive("is wide pointer", loc));
+  }
+
+  var rem = new unmanaged C(2);
+  on Locales[numLocales-1] {
+    rem.x += 1;
+    writeln("is 'rem' wide in on? ", __primitive("is wide pointer", rem));
+  }
+
+  writeln(loc.x, " ", rem.x);
+  delete loc, rem;
+}
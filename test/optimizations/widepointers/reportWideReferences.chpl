@@ -0,0 +1,24 @@
+class C {
+  var x: int;
+}
+
+proc bump(c: C) {
+  c.x += 1;
+}
+
+var total = 0;
+
+proc main() {
+  var c = new unmanaged C(1);
+  on c {
+    bump(c);
+  }
+
+  var d = new unmanaged C(2);
+  on Locales[numLocales-1] {
+    total += d.x;
+  }
+
+  writeln(c.x, " ", total);
+  delete c, d;
+}
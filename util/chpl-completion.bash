@@ -23,7 +23,9 @@ _chpl ()
       # developer options
       local devel_opts="\
 --atomics \
+--auto-aggregation \
 --aux-filesys \
+--backend-jobs \
 --baseline \
 --bounds-checks \
 --break-on-codegen \
@@ -39,6 +41,7 @@ _chpl ()
 --codegen \
 --comm \
 --comm-substrate \
+--compile-cache-dir \
 --compile-time-nil-checking \
 --copy-elision \
 --copy-propagation \
@@ -51,6 +54,7 @@ _chpl ()
 --default-dist \
 --denormalize \
 --devel \
+--devirtualize \
 --div-by-zero-checks \
 --dynamic \
 --early-deinit \
@@ -137,6 +141,7 @@ _chpl ()
 --munge-user-idents \
 --network-atomics \
 --nil-checks \
+--no-auto-aggregation \
 --no-bounds-checks \
 --no-cache-remote \
 --no-cast-checks \
@@ -153,6 +158,7 @@ _chpl ()
 --no-debug-short-loc \
 --no-denormalize \
 --no-devel \
+--no-devirtualize \
 --no-div-by-zero-checks \
 --no-early-deinit \
 --no-explain-verbose \
@@ -223,6 +229,7 @@ _chpl ()
 --no-scalar-replacement \
 --no-specialize \
 --no-split-initialization \
+--no-stack-allocate-classes \
 --no-stack-checks \
 --no-task-tracking \
 --no-tuple-copy-opt \
@@ -246,6 +253,7 @@ _chpl ()
 --override-checking \
 --parse-only \
 --parser-debug \
+--pass-threads \
 --permit-unhandled-module-errors \
 --prepend-internal-module-dir \
 --prepend-standard-module-dir \
@@ -264,11 +272,14 @@ _chpl ()
 --print-module-resolution \
 --print-passes \
 --print-passes-file \
+--print-passes-json \
 --print-search-dirs \
 --print-statistics \
 --print-unused-functions \
 --print-unused-internal-functions \
 --privatization \
+--profile-gen \
+--profile-use \
 --regexp \
 --region-vectorizer \
 --remote-serialization \
@@ -278,9 +289,12 @@ _chpl ()
 --remove-unreachable-blocks \
 --replace-array-accesses-with-ref-temps \
 --report-aliases \
+--report-auto-aggregation \
 --report-blocking \
 --report-dead-blocks \
 --report-dead-modules \
+--report-devirtualized-calls \
+--report-forwarded-fields \
 --report-inlined-iterators \
 --report-inlining \
 --report-optimized-forall-unordered-ops \
@@ -288,13 +302,16 @@ _chpl ()
 --report-optimized-on \
 --report-promotion \
 --report-scalar-replace \
+--report-stack-allocated-classes \
 --report-vectorized-loops \
+--report-wide-references \
 --savec \
 --scalar-replace-limit \
 --scalar-replacement \
 --set \
 --specialize \
 --split-initialization \
+--stack-allocate-classes \
 --stack-checks \
 --static \
 --stop-after-pass \
@@ -330,7 +347,9 @@ _chpl ()
       # non-developer options
       local nodevel_opts="\
 --atomics \
+--auto-aggregation \
 --aux-filesys \
+--backend-jobs \
 --baseline \
 --bounds-checks \
 --cache-remote \
@@ -340,6 +359,7 @@ _chpl ()
 --codegen \
 --comm \
 --comm-substrate \
+--compile-cache-dir \
 --copy-propagation \
 --copyright \
 --count-tokens \
@@ -347,6 +367,7 @@ _chpl ()
 --dead-code-elimination \
 --debug \
 --devel \
+--devirtualize \
 --div-by-zero-checks \
 --dynamic \
 --explain-call \
@@ -391,6 +412,7 @@ _chpl ()
 --munge-user-idents \
 --network-atomics \
 --nil-checks \
+--no-auto-aggregation \
 --no-bounds-checks \
 --no-cache-remote \
 --no-cast-checks \
@@ -402,6 +424,7 @@ _chpl ()
 --no-dead-code-elimination \
 --no-debug \
 --no-devel \
+--no-devirtualize \
 --no-div-by-zero-checks \
 --no-explain-verbose \
 --no-fast-followers \
@@ -439,6 +462,7 @@ _chpl ()
 --no-remove-copy-calls \
 --no-scalar-replacement \
 --no-specialize \
+--no-stack-allocate-classes \
 --no-stack-checks \
 --no-task-tracking \
 --no-tuple-copy-opt \
@@ -453,6 +477,7 @@ _chpl ()
 --optimize-on-clauses \
 --optimize-range-iteration \
 --output \
+--pass-threads \
 --permit-unhandled-module-errors \
 --print-all-candidates \
 --print-callgraph \
@@ -462,9 +487,12 @@ _chpl ()
 --print-module-files \
 --print-passes \
 --print-passes-file \
+--print-passes-json \
 --print-search-dirs \
 --print-unused-functions \
 --privatization \
+--profile-gen \
+--profile-use \
 --regexp \
 --remote-serialization \
 --remote-value-forwarding \
@@ -474,6 +502,7 @@ _chpl ()
 --scalar-replacement \
 --set \
 --specialize \
+--stack-allocate-classes \
 --stack-checks \
 --static \
 --target-arch \